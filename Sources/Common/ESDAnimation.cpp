@@ -0,0 +1,147 @@
+//==============================================================================
+/**
+@file       ESDAnimation.cpp
+
+@brief      Keyframe animations of the titles and images of the keys
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "ESDAnimation.h"
+
+#include <algorithm>
+
+
+void ESDAnimationTimeline::SetTitle(int inTimeMs, ESDStringID inContext, const std::string& inTitle, ESDSDKTarget inTarget)
+{
+	ESDKeyChange change;
+	change.mContext = inContext;
+	change.mIsImage = false;
+	change.mValue = inTitle;
+	change.mTarget = inTarget;
+	AddChange(inTimeMs, change);
+}
+
+void ESDAnimationTimeline::SetImage(int inTimeMs, ESDStringID inContext, const std::string& inBase64Image, ESDSDKTarget inTarget)
+{
+	ESDKeyChange change;
+	change.mContext = inContext;
+	change.mIsImage = true;
+	change.mValue = inBase64Image;
+	change.mTarget = inTarget;
+	AddChange(inTimeMs, change);
+}
+
+void ESDAnimationTimeline::AddChange(int inTimeMs, const ESDKeyChange& inChange)
+{
+	auto it = std::lower_bound(mKeyframes.begin(), mKeyframes.end(), inTimeMs, [](const Keyframe& inKeyframe, int inTime)
+	{
+		return inKeyframe.mTimeMs < inTime;
+	});
+	
+	if (it == mKeyframes.end() || it->mTimeMs != inTimeMs)
+	{
+		it = mKeyframes.insert(it, Keyframe());
+		it->mTimeMs = inTimeMs;
+	}
+	it->mChanges.push_back(inChange);
+}
+
+
+ESDAnimationPlayer::ESDAnimationPlayer(ESDKeyRenderer* inRenderer, ESDStringID inDeviceID) :
+	mRenderer(inRenderer),
+	mDeviceID(inDeviceID)
+{
+}
+
+ESDAnimationPlayer::~ESDAnimationPlayer()
+{
+	Stop();
+}
+
+void ESDAnimationPlayer::Play(const ESDAnimationTimeline& inTimeline, const std::function<void()>& inFinishedHandler)
+{
+	Stop();
+	
+	mTimeline = inTimeline;
+	mFinishedHandler = inFinishedHandler;
+	mStartTime = mRenderer != nullptr ? mRenderer->GetTime() : std::chrono::steady_clock::now();
+	mNextKeyframe = 0;
+	ScheduleNextKeyframe();
+}
+
+void ESDAnimationPlayer::Stop()
+{
+	if (mRenderer != nullptr && mTimerID != 0)
+		mRenderer->CancelTimer(mTimerID);
+	
+	mTimerID = 0;
+	mFinishedHandler = nullptr;
+}
+
+void ESDAnimationPlayer::ScheduleNextKeyframe()
+{
+	if (mRenderer == nullptr)
+		return;
+	
+	// Round up, so the keyframe is due when the timer expires
+	int delayMs = 0;
+	if (mNextKeyframe < mTimeline.mKeyframes.size())
+	{
+		std::chrono::steady_clock::time_point dueTime = mStartTime + std::chrono::milliseconds(mTimeline.mKeyframes[mNextKeyframe].mTimeMs);
+		std::chrono::microseconds remaining = std::chrono::duration_cast<std::chrono::microseconds>(dueTime - mRenderer->GetTime());
+		delayMs = (int)std::max<long long>(0, (remaining.count() + 999) / 1000);
+	}
+	
+	mTimerID = mRenderer->StartTimer(mDeviceID, delayMs, [this]()
+	{
+		mTimerID = 0;
+		SendDueKeyframes();
+	});
+}
+
+void ESDAnimationPlayer::SendDueKeyframes()
+{
+	const std::vector<ESDAnimationTimeline::Keyframe>& keyframes = mTimeline.mKeyframes;
+	int elapsedMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(mRenderer->GetTime() - mStartTime).count();
+	
+	// Merge the keyframes that are due, a later change of the same key replaces the earlier one
+	std::vector<ESDKeyChange> changes;
+	size_t dueKeyframes = 0;
+	while (mNextKeyframe < keyframes.size() && keyframes[mNextKeyframe].mTimeMs <= elapsedMs)
+	{
+		for (const ESDKeyChange& change : keyframes[mNextKeyframe].mChanges)
+		{
+			auto it = std::find_if(changes.begin(), changes.end(), [&change](const ESDKeyChange& inChange)
+			{
+				return inChange.mIsImage == change.mIsImage && inChange.mContext == change.mContext;
+			});
+			if (it != changes.end())
+				*it = change;
+			else
+				changes.push_back(change);
+		}
+		mNextKeyframe++;
+		dueKeyframes++;
+	}
+	
+	if (dueKeyframes > 1)
+		mDroppedFrames += dueKeyframes - 1;
+	if (!changes.empty())
+		mRenderer->SetKeys(changes);
+	
+	if (mNextKeyframe < keyframes.size())
+	{
+		ScheduleNextKeyframe();
+		return;
+	}
+	
+	// The handler may start the next animation or stop this one
+	std::function<void()> finishedHandler;
+	finishedHandler.swap(mFinishedHandler);
+	if (finishedHandler)
+		finishedHandler();
+}
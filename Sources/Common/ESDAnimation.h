@@ -0,0 +1,87 @@
+//==============================================================================
+/**
+@file       ESDAnimation.h
+
+@brief      Keyframe animations of the titles and images of the keys
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "ESDKeyRenderer.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Titles and images of keys at given times, in ms from the start of the animation
+class ESDAnimationTimeline
+{
+public:
+
+	void SetTitle(int inTimeMs, ESDStringID inContext, const std::string& inTitle, ESDSDKTarget inTarget = kESDSDKTarget_HardwareAndSoftware);
+	void SetImage(int inTimeMs, ESDStringID inContext, const std::string& inBase64Image, ESDSDKTarget inTarget = kESDSDKTarget_HardwareAndSoftware);
+
+	// Time of the last keyframe
+	int GetDurationMs() const { return mKeyframes.empty() ? 0 : mKeyframes.back().mTimeMs; }
+
+private:
+
+	friend class ESDAnimationPlayer;
+
+	// All key changes happening at the same time
+	struct Keyframe
+	{
+		int mTimeMs = 0;
+		std::vector<ESDKeyChange> mChanges;
+	};
+
+	void AddChange(int inTimeMs, const ESDKeyChange& inChange);
+
+	// Sorted by time
+	std::vector<Keyframe> mKeyframes;
+};
+
+// Plays timelines on the keys of one device. Each keyframe is sent as one batch, so all its keys change
+// together. The keyframes are timed from the start of the animation, not from the previous keyframe, so
+// late timers do not add up. If the player falls behind, the keyframes that are already due are merged
+// and only their final state is sent.
+// The player runs on the strand of its device and must only be used from there. The keyframes are timed
+// with the clock of the renderer.
+class ESDAnimationPlayer
+{
+public:
+
+	ESDAnimationPlayer(ESDKeyRenderer* inRenderer, ESDStringID inDeviceID);
+	~ESDAnimationPlayer();
+
+	// Starts playing the timeline, a running animation is stopped. The handler is called after the last keyframe.
+	void Play(const ESDAnimationTimeline& inTimeline, const std::function<void()>& inFinishedHandler);
+	// The remaining keyframes are not sent and the handler is not called. Can be called from the handler.
+	void Stop();
+	bool IsPlaying() const { return mTimerID != 0; }
+
+	// Keyframes merged into a later one because they were sent late
+	size_t GetDroppedFrames() const { return mDroppedFrames; }
+
+private:
+
+	void ScheduleNextKeyframe();
+	void SendDueKeyframes();
+
+	ESDKeyRenderer* mRenderer = nullptr;
+	ESDStringID mDeviceID = kESDNoStringID;
+
+	ESDAnimationTimeline mTimeline;
+	std::function<void()> mFinishedHandler;
+	std::chrono::steady_clock::time_point mStartTime;
+	size_t mNextKeyframe = 0;
+	ESDTimerID mTimerID = 0;
+
+	size_t mDroppedFrames = 0;
+};
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include "ESDSDKEvents.h"
+#include "ESDStringInterner.h"
+
 class ESDConnectionManager;
 
 class ESDBasePlugin
@@ -22,16 +25,31 @@ public:
 	
 	void SetConnectionManager(ESDConnectionManager * inConnectionManager) { mConnectionManager = inConnectionManager; }
 	
-	virtual void KeyDownForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) = 0;
-	virtual void KeyUpForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) = 0;
+	// The actions, contexts and devices of the events are interned, see ESDStringInterner::GetString() for their strings
+	
+	virtual void KeyDownForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) = 0;
+	virtual void KeyUpForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) = 0;
 	
-	virtual void WillAppearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) = 0;
-	virtual void WillDisappearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) = 0;
+	virtual void WillAppearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) = 0;
+	virtual void WillDisappearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) = 0;
 	
-	virtual void DeviceDidConnect(const std::string& inDeviceID, const json &inDeviceInfo) = 0;
-	virtual void DeviceDidDisconnect(const std::string& inDeviceID) = 0;
+	virtual void DeviceDidConnect(ESDStringID inDeviceID, const json &inDeviceInfo) = 0;
+	virtual void DeviceDidDisconnect(ESDStringID inDeviceID) = 0;
 
-	virtual void SendToPlugin(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) = 0;
+	virtual void SendToPlugin(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) = 0;
+	
+	// Optional events, ignored by default
+	virtual void ApplicationDidLaunch(const json &/*inPayload*/) { }
+	virtual void ApplicationDidTerminate(const json &/*inPayload*/) { }
+	virtual void SystemDidWakeUp() { }
+	virtual void TitleParametersDidChange(ESDStringID /*inAction*/, ESDStringID /*inContext*/, const json &/*inPayload*/, ESDStringID /*inDeviceID*/) { }
+	virtual void DidReceiveSettings(ESDStringID /*inAction*/, ESDStringID /*inContext*/, const json &/*inPayload*/, ESDStringID /*inDeviceID*/) { }
+	virtual void DidReceiveGlobalSettings(const json &/*inPayload*/) { }
+	virtual void PropertyInspectorDidAppear(ESDStringID /*inAction*/, ESDStringID /*inContext*/, ESDStringID /*inDeviceID*/) { }
+	virtual void PropertyInspectorDidDisappear(ESDStringID /*inAction*/, ESDStringID /*inContext*/, ESDStringID /*inDeviceID*/) { }
+	
+	// Return false if the handler of the event does not use its payload, so it does not need to be decoded
+	virtual bool NeedsPayloadForEvent(ESDSDKEventType /*inEventType*/) { return true; }
 	
 protected:
 	ESDConnectionManager *mConnectionManager = nullptr;
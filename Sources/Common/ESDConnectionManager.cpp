@@ -13,18 +13,55 @@
 #include "ESDConnectionManager.h"
 #include "EPLJSONUtils.h"
 
+#include <cstring>
+#include <fstream>
+
+thread_local ESDConnectionManager::EventOrigin ESDConnectionManager::sCurrentEventOrigin;
+
+static uint64_t GetMicrosecondsSince(std::chrono::steady_clock::time_point inTime)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - inTime).count();
+}
+
 
 void ESDConnectionManager::OnOpen(WebsocketClient* inClient, websocketpp::connection_hdl inConnectionHandler)
 {
 	DebugPrint("OnOpen");
 	
-	// Register plugin with StreamDeck
+	mReconnectAttempts = 0;
+	mWasConnected = true;
+	
+	// Register plugin with StreamDeck. Sent before the queue, which may hold messages requested while disconnected.
 	json jsonObject;
 	jsonObject["event"] = mRegisterEvent;
 	jsonObject["uuid"] = mPluginUUID;
 
 	websocketpp::lib::error_code ec;
 	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	
+	// After a reconnect the keys show whatever the Stream Deck application restored, send the last state of each key again
+	ReplayKeySnapshots();
+}
+
+void ESDConnectionManager::CheckCompressionNegotiation(const WebsocketClient::connection_ptr& inConnection)
+{
+	// websocketpp drops the connection if it cannot accept the permessage-deflate settings of the server,
+	// reconnect without offering compression in that case
+	if (inConnection->get_ec() == websocketpp::error::make_error_code(websocketpp::error::extension_neg_failed))
+	{
+		DebugPrint("permessage-deflate negotiation failed, continuing without compression\n");
+		ESDWebsocketConfig::permessage_deflate_type::SetOffered(false);
+	}
+}
+
+void ESDConnectionManager::OnDisconnected()
+{
+	if (mWasConnected)
+	{
+		mWasConnected = false;
+		mDisconnectTime = std::chrono::steady_clock::now();
+		mRecoveryPending = true;
+	}
 }
 
 void ESDConnectionManager::OnFail(WebsocketClient* inClient, websocketpp::connection_hdl inConnectionHandler)
@@ -37,10 +74,12 @@ void ESDConnectionManager::OnFail(WebsocketClient* inClient, websocketpp::connec
 		if(connection != NULL)
 		{
 			reason = connection->get_ec().message();
+			CheckCompressionNegotiation(connection);
 		}
 	}
 	
 	DebugPrint("Failed with reason: %s\n", reason.c_str());
+	OnDisconnected();
 }
 
 void ESDConnectionManager::OnClose(WebsocketClient* inClient, websocketpp::connection_hdl inConnectionHandler)
@@ -53,65 +92,228 @@ void ESDConnectionManager::OnClose(WebsocketClient* inClient, websocketpp::conne
 		if(connection != NULL)
 		{
 			reason = connection->get_remote_close_reason();
+			CheckCompressionNegotiation(connection);
 		}
 	}
 	
 	DebugPrint("Close with reason: %s\n", reason.c_str());
+	DebugPrint("Message buffers allocated: %zu\n", ESDWebsocketConfig::con_msg_manager_type::GetAllocationCount());
+	DebugPrint("Superseded drops: %zu, backpressure drops: %zu, deferred flushes: %zu, send errors: %zu\n",
+		mSupersededDrops.load(), mBackpressureDrops.load(), mDeferredFlushes.load(), mSendErrors.load());
+	DebugPrint("Bytes sent: %zu raw, %zu on the wire, setImage: %zu raw, %zu on the wire\n",
+		mRawBytesSent.load(), mWireBytesSent.load(), mImageRawBytesSent.load(), mImageWireBytesSent.load());
+	OnDisconnected();
 }
 
 void ESDConnectionManager::OnMessage(websocketpp::connection_hdl, WebsocketClient::message_ptr inMsg)
 {
 	if (inMsg != NULL && inMsg->get_opcode() == websocketpp::frame::opcode::text)
 	{
-		std::string message = inMsg->get_payload();
+		std::chrono::steady_clock::time_point receivedTime = std::chrono::steady_clock::now();
+		const std::string& message = inMsg->get_payload();
 		DebugPrint("OnMessage: %s\n", message.c_str());
 		
 		try
 		{
-			json receivedJson = json::parse(message);
+			// Only called from the event loop, so the decoder can be reused
+			if (!mEventDecoder.Decode(message, mPlugin))
+				return;
 			
-			std::string event = EPLJSONUtils::GetStringByName(receivedJson, kESDSDKCommonEvent);
-			std::string context = EPLJSONUtils::GetStringByName(receivedJson, kESDSDKCommonContext);
-			std::string action = EPLJSONUtils::GetStringByName(receivedJson, kESDSDKCommonAction);
-			std::string deviceID = EPLJSONUtils::GetStringByName(receivedJson, kESDSDKCommonDevice);
-			json payload;
-			EPLJSONUtils::GetObjectByName(receivedJson, kESDSDKCommonPayload, payload);
-
-			if(event == kESDSDKEventKeyDown)
+			if (mEventDecoder.GetEventType() == kESDSDKEventType_Unknown)
 			{
-				mPlugin->KeyDownForAction(action, context, payload, deviceID);
+				DebugPrint("Unknown event: %s\n", mEventDecoder.GetEvent().c_str());
+				return;
 			}
-			else if(event == kESDSDKEventKeyUp)
+			
+			InboundEvent event;
+			event.mEventType = mEventDecoder.GetEventType();
+			event.mReceivedTime = receivedTime;
+			
+			// From here on the plugin works with the handles, equal contexts and devices are compared as integers
+			ESDStringInterner& interner = ESDStringInterner::Get();
+			event.mContext = interner.Intern(mEventDecoder.GetContext());
+			event.mAction = interner.Intern(mEventDecoder.GetAction());
+			event.mDeviceID = interner.Intern(mEventDecoder.GetDeviceID());
+			event.mPayload = mEventDecoder.GetPayload();
+			event.mDeviceInfo = mEventDecoder.GetDeviceInfo();
+			
+			// Run the plugin handler on a worker, so the network loop never waits for the game logic
+			websocketpp::lib::asio::io_service::strand& strand = GetDeviceStrand(event.mDeviceID);
+			strand.post([this, event = std::move(event)]()
 			{
+				DispatchEvent(event);
+			});
+		}
+		catch (const std::exception& inException)
+		{
+			// An event that cannot be decoded or interned, for example once the string handles ran out, is reported
+			LogMessage(std::string("Dropped an event: ") + inException.what());
+		}
+		catch (...)
+		{
+		}
+	}
+}
+
+void ESDConnectionManager::DispatchEvent(const InboundEvent& inEvent)
+{
+	try
+	{
+		ESDStringID context = inEvent.mContext;
+		ESDStringID action = inEvent.mAction;
+		ESDStringID deviceID = inEvent.mDeviceID;
+		const json& payload = inEvent.mPayload;
+		
+		// The messages requested by the handler carry the time the event was received
+		sCurrentEventOrigin.mEventType = inEvent.mEventType;
+		sCurrentEventOrigin.mReceivedTime = inEvent.mReceivedTime;
+		
+		switch (inEvent.mEventType)
+		{
+			case kESDSDKEventType_KeyDown:
+				mPlugin->KeyDownForAction(action, context, payload, deviceID);
+				break;
+			case kESDSDKEventType_KeyUp:
 				mPlugin->KeyUpForAction(action, context, payload, deviceID);
-			}
-			else if(event == kESDSDKEventWillAppear)
-			{
+				break;
+			case kESDSDKEventType_WillAppear:
+				AddKeySnapshot(context, deviceID);
 				mPlugin->WillAppearForAction(action, context, payload, deviceID);
-			}
-			else if(event == kESDSDKEventWillDisappear)
-			{
+				break;
+			case kESDSDKEventType_WillDisappear:
 				mPlugin->WillDisappearForAction(action, context, payload, deviceID);
-			}
-			else if(event == kESDSDKEventDeviceDidConnect)
-			{
-				json deviceInfo;
-				EPLJSONUtils::GetObjectByName(receivedJson, kESDSDKCommonDeviceInfo, deviceInfo);
-				mPlugin->DeviceDidConnect(deviceID, deviceInfo);
-			}
-			else if(event == kESDSDKEventDeviceDidDisconnect)
-			{
+				RemoveKeySnapshot(context);
+				break;
+			case kESDSDKEventType_DeviceDidConnect:
+				mPlugin->DeviceDidConnect(deviceID, inEvent.mDeviceInfo);
+				break;
+			case kESDSDKEventType_DeviceDidDisconnect:
 				mPlugin->DeviceDidDisconnect(deviceID);
-			}
-			else if (event == kESDSDKEventSendToPlugin)
-			{
+				RemoveKeySnapshotsOfDevice(deviceID);
+				break;
+			case kESDSDKEventType_ApplicationDidLaunch:
+				mPlugin->ApplicationDidLaunch(payload);
+				break;
+			case kESDSDKEventType_ApplicationDidTerminate:
+				mPlugin->ApplicationDidTerminate(payload);
+				break;
+			case kESDSDKEventType_SystemDidWakeUp:
+				mPlugin->SystemDidWakeUp();
+				break;
+			case kESDSDKEventType_TitleParametersDidChange:
+				mPlugin->TitleParametersDidChange(action, context, payload, deviceID);
+				break;
+			case kESDSDKEventType_DidReceiveSettings:
+				mPlugin->DidReceiveSettings(action, context, payload, deviceID);
+				break;
+			case kESDSDKEventType_DidReceiveGlobalSettings:
+				mPlugin->DidReceiveGlobalSettings(payload);
+				break;
+			case kESDSDKEventType_PropertyInspectorDidAppear:
+				mPlugin->PropertyInspectorDidAppear(action, context, deviceID);
+				break;
+			case kESDSDKEventType_PropertyInspectorDidDisappear:
+				mPlugin->PropertyInspectorDidDisappear(action, context, deviceID);
+				break;
+			case kESDSDKEventType_SendToPlugin:
 				mPlugin->SendToPlugin(action, context, payload, deviceID);
-			}
+				break;
+			default:
+				break;
 		}
-		catch (...)
+	}
+	catch (...)
+	{
+	}
+	
+	sCurrentEventOrigin = EventOrigin();
+	mDispatchLatencies[inEvent.mEventType].Record(GetMicrosecondsSince(inEvent.mReceivedTime));
+}
+
+websocketpp::lib::asio::io_service::strand& ESDConnectionManager::GetDeviceStrand(ESDStringID inDeviceID)
+{
+	std::lock_guard<std::mutex> lock(mDeviceStrandsMutex);
+	
+	// The strands are never removed, so the reference stays valid
+	std::unique_ptr<websocketpp::lib::asio::io_service::strand>& strand = mDeviceStrands[inDeviceID];
+	if (!strand)
+		strand.reset(new websocketpp::lib::asio::io_service::strand(mEventWorkerService));
+	return *strand;
+}
+
+void ESDConnectionManager::PostToDevice(ESDStringID inDeviceID, const std::function<void()>& inHandler)
+{
+	GetDeviceStrand(inDeviceID).post(inHandler);
+}
+
+ESDTimerID ESDConnectionManager::StartTimer(ESDStringID inDeviceID, int inDelayMs, const std::function<void()>& inHandler)
+{
+	std::shared_ptr<websocketpp::lib::asio::steady_timer> timer = std::make_shared<websocketpp::lib::asio::steady_timer>(mEventWorkerService);
+	timer->expires_from_now(std::chrono::milliseconds(inDelayMs));
+	
+	ESDTimerID timerID = 0;
+	
+	{
+		std::lock_guard<std::mutex> lock(mTimersMutex);
+		timerID = ++mLastTimerID;
+		mTimers[timerID] = timer;
+	}
+	
+	timer->async_wait(GetDeviceStrand(inDeviceID).wrap([this, timerID, inHandler](const websocketpp::lib::error_code&)
+	{
+		// A timer that expired while it was cancelled is not in the map anymore
 		{
+			std::lock_guard<std::mutex> lock(mTimersMutex);
+			if (mTimers.erase(timerID) == 0)
+				return;
 		}
+		
+		inHandler();
+	}));
+	
+	return timerID;
+}
+
+void ESDConnectionManager::CancelTimer(ESDTimerID inTimerID)
+{
+	std::lock_guard<std::mutex> lock(mTimersMutex);
+	
+	auto it = mTimers.find(inTimerID);
+	if (it != mTimers.end())
+	{
+		it->second->cancel();
+		mTimers.erase(it);
+	}
+}
+
+void ESDConnectionManager::StartEventWorkers()
+{
+	mEventWorkerWork.reset(new websocketpp::lib::asio::io_service::work(mEventWorkerService));
+	for (size_t i = 0; i < kEventWorkerCount; i++)
+	{
+		mEventWorkers.emplace_back([this]()
+		{
+			mEventWorkerService.run();
+		});
+	}
+}
+
+void ESDConnectionManager::StopEventWorkers()
+{
+	// Let the workers finish the events that were already received, the timers would keep them running
+	{
+		std::lock_guard<std::mutex> lock(mTimersMutex);
+		for (auto& timer : mTimers)
+			timer.second->cancel();
+		mTimers.clear();
+	}
+	mEventWorkerWork.reset();
+	for (std::thread& worker : mEventWorkers)
+	{
+		if (worker.joinable())
+			worker.join();
 	}
+	mEventWorkers.clear();
 }
 
 ESDConnectionManager::ESDConnectionManager(
@@ -140,112 +342,649 @@ void ESDConnectionManager::Run()
 		
 		// Initialize ASIO
 		mWebsocket.init_asio();
+		mOutboundStrand.reset(new websocketpp::lib::asio::io_service::strand(mWebsocket.get_io_service()));
+		mFlushRetryTimer.reset(new websocketpp::lib::asio::steady_timer(mWebsocket.get_io_service()));
 		
 		// Register our message handler
 		mWebsocket.set_open_handler(websocketpp::lib::bind(&ESDConnectionManager::OnOpen, this, &mWebsocket, websocketpp::lib::placeholders::_1));
 		mWebsocket.set_fail_handler(websocketpp::lib::bind(&ESDConnectionManager::OnFail, this, &mWebsocket, websocketpp::lib::placeholders::_1));
 		mWebsocket.set_close_handler(websocketpp::lib::bind(&ESDConnectionManager::OnClose, this, &mWebsocket, websocketpp::lib::placeholders::_1));
 		mWebsocket.set_message_handler(websocketpp::lib::bind(&ESDConnectionManager::OnMessage, this, websocketpp::lib::placeholders::_1, websocketpp::lib::placeholders::_2));
+	}
+	catch (websocketpp::exception const & e)
+	{
+		// Prevent an unused variable warning in release builds
+		(void)e;
+		DebugPrint("Websocket threw an exception: %s\n", e.what());
+		return;
+	}
+	
+	// The plugin handlers run on the event workers, the network loop only decodes and sends.
+	// They keep running across reconnects, so the games are not lost when the socket drops.
+	StartEventWorkers();
+	
+	int reconnectDelayMs = kReconnectInitialDelayMs;
+	
+	while (true)
+	{
+		try
+		{
+			websocketpp::lib::error_code ec;
+			std::string uri = "ws://127.0.0.1:" + std::to_string(mPort);
+			WebsocketClient::connection_ptr connection = mWebsocket.get_connection(uri, ec);
+			if (ec)
+			{
+				DebugPrint("Connect initialization error: %s\n", ec.message().c_str());
+				break;
+			}
+			
+			mConnectionHandle = connection->get_handle();
+			std::atomic_store(&mConnection, connection);
+			
+			// Note that connect here only requests a connection. No network messages are
+			// exchanged until the event loop starts running in the next line.
+			mWebsocket.connect(connection);
+			
+			// Start the ASIO io_service run loop
+			// this will cause a single connection to be made to the server. mWebsocket.run()
+			// will exit when this connection is closed.
+			mWebsocket.run();
+		}
+		catch (websocketpp::exception const & e)
+		{
+			// Prevent an unused variable warning in release builds
+			(void)e;
+			DebugPrint("Websocket threw an exception: %s\n", e.what());
+		}
 		
-		websocketpp::lib::error_code ec;
-		std::string uri = "ws://127.0.0.1:" + std::to_string(mPort);
-		WebsocketClient::connection_ptr connection = mWebsocket.get_connection(uri, ec);
-		if (ec)
+		// Reconnect with exponential backoff, the delay starts over once a connection was opened
+		if (mReconnectAttempts == 0)
+			reconnectDelayMs = kReconnectInitialDelayMs;
+		if (++mReconnectAttempts > kMaxReconnectAttempts)
 		{
-			DebugPrint("Connect initialization error: %s\n", ec.message().c_str());
-			return;
+			DebugPrint("Giving up after %d reconnect attempts\n", kMaxReconnectAttempts);
+			break;
+		}
+		
+		DebugPrint("Reconnecting in %d ms\n", reconnectDelayMs);
+		std::this_thread::sleep_for(std::chrono::milliseconds(reconnectDelayMs));
+		reconnectDelayMs = std::min(reconnectDelayMs * 2, kReconnectMaxDelayMs);
+		
+		mWebsocket.reset();
+	}
+	
+	StopEventWorkers();
+}
+
+void ESDConnectionManager::QueueKeyUpdate(ESDStringID inContext, bool inIsImage, const message_ptr& inMessage)
+{
+	if (!inMessage)
+		return;
+	
+	bool scheduleFlush = false;
+	
+	{
+		std::lock_guard<std::mutex> lock(mPendingMutex);
+		scheduleFlush = QueueKeyUpdateLocked(inContext, inIsImage, inMessage);
+	}
+	
+	if (scheduleFlush)
+		ScheduleFlush();
+}
+
+bool ESDConnectionManager::QueueKeyUpdateLocked(ESDStringID inContext, bool inIsImage, const message_ptr& inMessage)
+{
+	// While the connection is backed up, the updates queued before other messages are dropped as well
+	// if they are superseded. The other messages are still sent in order.
+	if (mSendBackpressure)
+	{
+		for (size_t i = 0; i < mPendingCoalesceStart; i++)
+		{
+			PendingKeyUpdate& staleUpdate = mPendingKeyUpdates[i];
+			message_ptr& staleMessage = inIsImage ? staleUpdate.mImageMessage : staleUpdate.mTitleMessage;
+			if (staleMessage && staleUpdate.mContext == inContext)
+			{
+				staleMessage.reset();
+				mBackpressureDrops++;
+			}
+		}
+	}
+	
+	PendingKeyUpdate* update = nullptr;
+	for (size_t i = mPendingCoalesceStart; i < mPendingKeyUpdateCount; i++)
+	{
+		if (mPendingKeyUpdates[i].mContext == inContext)
+		{
+			update = &mPendingKeyUpdates[i];
+			break;
 		}
+	}
+	
+	if (update == nullptr)
+	{
+		if (mPendingKeyUpdateCount == mPendingKeyUpdates.size())
+			mPendingKeyUpdates.emplace_back();
+		update = &mPendingKeyUpdates[mPendingKeyUpdateCount++];
+		update->mContext = inContext;
+	}
+	
+	// Last write wins, a superseded update never reaches the socket
+	message_ptr& queuedMessage = inIsImage ? update->mImageMessage : update->mTitleMessage;
+	if (queuedMessage)
+		mSupersededDrops++;
+	queuedMessage = inMessage;
+	(inIsImage ? update->mImageOrigin : update->mTitleOrigin) = sCurrentEventOrigin;
+	
+	// Remember the latest state of the key for a reconnect, the string keeps its capacity for the next update
+	auto snapshot = mKeySnapshots.find(inContext);
+	if (snapshot != mKeySnapshots.end())
+		(inIsImage ? snapshot->second.mImagePayload : snapshot->second.mTitlePayload).assign(inMessage->get_payload());
+	
+	bool scheduleFlush = !mFlushScheduled;
+	mFlushScheduled = true;
+	return scheduleFlush;
+}
+
+void ESDConnectionManager::QueueFrame(const message_ptr& inMessage)
+{
+	if (!inMessage)
+		return;
+	
+	bool scheduleFlush = false;
+	
+	{
+		std::lock_guard<std::mutex> lock(mPendingMutex);
 		
-		mConnectionHandle = connection->get_handle();
+		if (mPendingKeyUpdateCount == mPendingKeyUpdates.size())
+			mPendingKeyUpdates.emplace_back();
+		PendingKeyUpdate& entry = mPendingKeyUpdates[mPendingKeyUpdateCount++];
+		entry.mContext = kESDNoStringID;
+		entry.mFrameMessage = inMessage;
+		entry.mFrameOrigin = sCurrentEventOrigin;
 		
-		// Note that connect here only requests a connection. No network messages are
-		// exchanged until the event loop starts running in the next line.
-		mWebsocket.connect(connection);
+		// Keep the order with the key updates that are requested after this message
+		mPendingCoalesceStart = mPendingKeyUpdateCount;
 		
-		// Start the ASIO io_service run loop
-		// this will cause a single connection to be made to the server. mWebsocket.run()
-		// will exit when this connection is closed.
-		mWebsocket.run();
+		scheduleFlush = !mFlushScheduled;
+		mFlushScheduled = true;
 	}
-	catch (websocketpp::exception const & e)
+	
+	if (scheduleFlush)
+		ScheduleFlush();
+}
+
+void ESDConnectionManager::ScheduleFlush()
+{
+	// Flush on the network thread once the current handlers return to the event loop
+	if (mOutboundStrand)
+		mOutboundStrand->post(websocketpp::lib::bind(&ESDConnectionManager::FlushKeyUpdates, this));
+}
+
+void ESDConnectionManager::FlushKeyUpdates()
+{
+	// Keep the queue while disconnected, the flush is scheduled again when the connection opens
+	WebsocketClient::connection_ptr connection = std::atomic_load(&mConnection);
+	if (!connection || connection->get_state() != websocketpp::session::state::open)
+		return;
+	
+	// Hold the queue back while the connection is not draining, so the key updates keep being coalesced
+	size_t bytesInFlight = connection->get_buffered_amount();
+	mBytesInFlight = bytesInFlight;
+	mSendBackpressure = bytesInFlight > mSendHighWaterMark;
+	if (mSendBackpressure)
 	{
-		// Prevent an unused variable warning in release builds
-		(void)e;
-		DebugPrint("Websocket threw an exception: %s\n", e.what());
-    }
+		mDeferredFlushes++;
+		
+		// The pending retry flushes the queue, re-arming the timer would cancel it
+		if (mFlushRetryPending)
+			return;
+		mFlushRetryPending = true;
+		mFlushRetryTimer->expires_from_now(std::chrono::milliseconds(kFlushRetryIntervalMs));
+		mFlushRetryTimer->async_wait(mOutboundStrand->wrap([this](const websocketpp::lib::error_code& inError)
+		{
+			mFlushRetryPending = false;
+			if (inError == websocketpp::lib::asio::error::operation_aborted)
+				return;
+			FlushKeyUpdates();
+		}));
+		return;
+	}
+	
+	size_t count = 0;
+	
+	{
+		std::lock_guard<std::mutex> lock(mPendingMutex);
+		mFlushingKeyUpdates.swap(mPendingKeyUpdates);
+		count = mPendingKeyUpdateCount;
+		mPendingKeyUpdateCount = 0;
+		mPendingCoalesceStart = 0;
+		mFlushScheduled = false;
+	}
+	
+	for (size_t i = 0; i < count; i++)
+	{
+		PendingKeyUpdate& update = mFlushingKeyUpdates[i];
+		
+		if (update.mFrameMessage)
+		{
+			SendQueuedMessage(update.mFrameMessage, false, update.mFrameOrigin);
+			update.mFrameMessage.reset();
+		}
+		if (update.mTitleMessage)
+		{
+			SendQueuedMessage(update.mTitleMessage, false, update.mTitleOrigin);
+			update.mTitleMessage.reset();
+		}
+		if (update.mImageMessage)
+		{
+			SendQueuedMessage(update.mImageMessage, true, update.mImageOrigin);
+			update.mImageMessage.reset();
+		}
+	}
+	
+	mBytesInFlight = connection->get_buffered_amount();
+	
+	if (mRecoveryPending)
+	{
+		// The board is back to its last state
+		mRecoveryPending = false;
+		mLastRecoveryTimeMs = (size_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mDisconnectTime).count();
+		DebugPrint("Recovered from the connection drop in %zu ms\n", mLastRecoveryTimeMs.load());
+		LogMessage("Reconnected, board restored " + std::to_string(mLastRecoveryTimeMs) + " ms after the connection dropped");
+	}
 }
 
-void ESDConnectionManager::SetTitle(const std::string &inTitle, const std::string& inContext, ESDSDKTarget inTarget)
+// Replayed messages live outside of the pool like the prepared images, a reconnect is rare
+static message_ptr CreateSnapshotMessage(const std::string& inPayload)
 {
-	json jsonObject;
+	if (inPayload.empty())
+		return nullptr;
+	
+	message_ptr message = websocketpp::lib::make_shared<ESDWebsocketConfig::message_type>(ESDWebsocketConfig::con_msg_manager_type::ptr(), websocketpp::frame::opcode::text, inPayload.size());
+	message->set_compressed(true);
+	message->get_raw_payload() = inPayload;
+	return message;
+}
+
+void ESDConnectionManager::ReplayKeySnapshots()
+{
+	{
+		std::lock_guard<std::mutex> lock(mPendingMutex);
+		
+		// The queued key updates are part of the snapshots, only the other messages are kept
+		for (size_t i = 0; i < mPendingKeyUpdateCount; i++)
+		{
+			mPendingKeyUpdates[i].mTitleMessage.reset();
+			mPendingKeyUpdates[i].mImageMessage.reset();
+		}
+		mPendingCoalesceStart = mPendingKeyUpdateCount;
+		
+		for (const auto& snapshot : mKeySnapshots)
+		{
+			if (snapshot.second.mTitlePayload.empty() && snapshot.second.mImagePayload.empty())
+				continue;
+			
+			if (mPendingKeyUpdateCount == mPendingKeyUpdates.size())
+				mPendingKeyUpdates.emplace_back();
+			PendingKeyUpdate& update = mPendingKeyUpdates[mPendingKeyUpdateCount++];
+			update.mContext = snapshot.first;
+			update.mTitleMessage = CreateSnapshotMessage(snapshot.second.mTitlePayload);
+			update.mImageMessage = CreateSnapshotMessage(snapshot.second.mImagePayload);
+			update.mTitleOrigin = EventOrigin();
+			update.mImageOrigin = EventOrigin();
+		}
+		
+		mFlushScheduled = true;
+	}
+	
+	ScheduleFlush();
+}
 
-	jsonObject[kESDSDKCommonEvent] = kESDSDKEventSetTitle;
-	jsonObject[kESDSDKCommonContext] = inContext;
+void ESDConnectionManager::AddKeySnapshot(ESDStringID inContext, ESDStringID inDeviceID)
+{
+	std::lock_guard<std::mutex> lock(mPendingMutex);
+	mKeySnapshots[inContext].mDeviceID = inDeviceID;
+}
 
-	json payload;
-	payload[kESDSDKPayloadTarget] = inTarget;
-	payload[kESDSDKPayloadTitle] = inTitle;
-	jsonObject[kESDSDKCommonPayload] = payload;
+void ESDConnectionManager::RemoveKeySnapshot(ESDStringID inContext)
+{
+	std::lock_guard<std::mutex> lock(mPendingMutex);
+	mKeySnapshots.erase(inContext);
+}
+
+void ESDConnectionManager::RemoveKeySnapshotsOfDevice(ESDStringID inDeviceID)
+{
+	std::lock_guard<std::mutex> lock(mPendingMutex);
+	for (auto it = mKeySnapshots.begin(); it != mKeySnapshots.end();)
+	{
+		if (it->second.mDeviceID == inDeviceID)
+			it = mKeySnapshots.erase(it);
+		else
+			++it;
+	}
+}
+
+void ESDConnectionManager::SendQueuedMessage(const message_ptr& inMessage, bool inIsImage, const EventOrigin& inOrigin)
+{
+	// websocketpp adds the compressed payload to the buffered amount right away, and only the network
+	// thread removes it again once it is written, so the difference is the size on the wire
+	WebsocketClient::connection_ptr connection = std::atomic_load(&mConnection);
+	size_t bufferedBefore = connection ? connection->get_buffered_amount() : 0;
 	
 	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	mWebsocket.send(mConnectionHandle, inMessage, ec);
+	if (ec)
+	{
+		mSendErrors++;
+		DebugPrint("Send failed: %s\n", ec.message().c_str());
+		return;
+	}
+	
+	size_t rawBytes = inMessage->get_payload().size();
+	size_t wireBytes = connection ? connection->get_buffered_amount() - bufferedBefore : rawBytes;
+	mRawBytesSent += rawBytes;
+	mWireBytesSent += wireBytes;
+	if (inIsImage)
+	{
+		mImageRawBytesSent += rawBytes;
+		mImageWireBytesSent += wireBytes;
+	}	
+	if (inOrigin.mEventType != kESDSDKEventType_Unknown)
+		mRenderLatencies[inOrigin.mEventType].Record(GetMicrosecondsSince(inOrigin.mReceivedTime));
 }
 
-void ESDConnectionManager::SetImage(const std::string &inBase64ImageString, const std::string& inContext, ESDSDKTarget inTarget)
+std::string ESDConnectionManager::GetLatencyReport() const
 {
-	json jsonObject;
+	std::string report = "Latencies in us (count / p50 / p99 / max)";
+	
+	for (ESDSDKEventType eventType = kESDSDKEventType_Unknown + 1; eventType < kESDSDKEventType_Count; eventType++)
+	{
+		const ESDLatencyHistogram& dispatch = mDispatchLatencies[eventType];
+		const ESDLatencyHistogram& render = mRenderLatencies[eventType];
+		if (dispatch.GetCount() == 0)
+			continue;
+		
+		char line[256];
+		snprintf(line, sizeof(line), "\n%s dispatch: %llu / %llu / %llu / %llu, render: %llu / %llu / %llu / %llu",
+			ESDSDKGetEventName(eventType),
+			(unsigned long long)dispatch.GetCount(), (unsigned long long)dispatch.GetPercentile(50), (unsigned long long)dispatch.GetPercentile(99), (unsigned long long)dispatch.GetMax(),
+			(unsigned long long)render.GetCount(), (unsigned long long)render.GetPercentile(50), (unsigned long long)render.GetPercentile(99), (unsigned long long)render.GetMax());
+		report.append(line);
+	}
+	
+	return report;
+}
 
-	jsonObject[kESDSDKCommonEvent] = kESDSDKEventSetImage;
-	jsonObject[kESDSDKCommonContext] = inContext;
+void ESDConnectionManager::LogLatencyReport()
+{
+	LogMessage(GetLatencyReport());
+}
 
-	json payload;
-	payload[kESDSDKPayloadTarget] = inTarget;
-	const std::string prefix = "data:image/png;base64,";
-	if (inBase64ImageString.empty() || inBase64ImageString.substr(0, prefix.length()).find(prefix) == 0)
-		payload[kESDSDKPayloadImage] = inBase64ImageString;
+bool ESDConnectionManager::WriteLatencyReport(const std::string& inPath) const
+{
+	std::ofstream file(inPath, std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	
+	file << GetLatencyReport() << std::endl;
+	return file.good();
+}
+
+ESDSendStatistics ESDConnectionManager::GetSendStatistics() const
+{
+	ESDSendStatistics statistics;
+	statistics.mBytesInFlight = mBytesInFlight;
+	statistics.mSupersededDrops = mSupersededDrops;
+	statistics.mBackpressureDrops = mBackpressureDrops;
+	statistics.mDeferredFlushes = mDeferredFlushes;
+	statistics.mSendErrors = mSendErrors;
+	statistics.mRawBytesSent = mRawBytesSent;
+	statistics.mWireBytesSent = mWireBytesSent;
+	statistics.mImageRawBytesSent = mImageRawBytesSent;
+	statistics.mImageWireBytesSent = mImageWireBytesSent;
+	return statistics;
+}
+
+void ESDConnectionManager::SendFrame(const std::string& inMessage)
+{
+	message_ptr message = GetMessageBuffer(inMessage.size());
+	if (!message)
+		return;
+	
+	message->get_raw_payload().assign(inMessage);
+	QueueFrame(message);
+}
+
+message_ptr ESDConnectionManager::GetMessageBuffer(size_t inSizeHint)
+{
+	WebsocketClient::connection_ptr connection = std::atomic_load(&mConnection);
+	if (!connection)
+		return nullptr;
+	
+	message_ptr message = connection->get_message(websocketpp::frame::opcode::text, inSizeHint);
+	message->set_compressed(true);
+	return message;
+}
+
+// Append a JSON string literal, escaped the same way as json::dump()
+static void AppendJSONString(std::string& ioMessage, const char* inString, size_t inSize)
+{
+	static const char kHexDigits[] = "0123456789abcdef";
+	
+	ioMessage.push_back('"');
+	for (size_t i = 0; i < inSize; i++)
+	{
+		char character = inString[i];
+		switch (character)
+		{
+			case '"':	ioMessage.append("\\\"", 2); break;
+			case '\\':	ioMessage.append("\\\\", 2); break;
+			case '\b':	ioMessage.append("\\b", 2); break;
+			case '\f':	ioMessage.append("\\f", 2); break;
+			case '\n':	ioMessage.append("\\n", 2); break;
+			case '\r':	ioMessage.append("\\r", 2); break;
+			case '\t':	ioMessage.append("\\t", 2); break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+				{
+					ioMessage.append("\\u00", 4);
+					ioMessage.push_back(kHexDigits[(character >> 4) & 0x0F]);
+					ioMessage.push_back(kHexDigits[character & 0x0F]);
+				}
+				else
+				{
+					ioMessage.push_back(character);
+				}
+				break;
+		}
+	}
+	ioMessage.push_back('"');
+}
+
+static void AppendJSONString(std::string& ioMessage, const std::string& inString)
+{
+	AppendJSONString(ioMessage, inString.data(), inString.size());
+}
+
+void ESDConnectionManager::WriteSetTitleMessage(std::string& outMessage, const std::string &inTitle, const std::string& inContext, ESDSDKTarget inTarget)
+{
+	// {"context":"...","event":"setTitle","payload":{"target":0,"title":"..."}}
+	outMessage.append("{\"" kESDSDKCommonContext "\":");
+	AppendJSONString(outMessage, inContext);
+	outMessage.append(",\"" kESDSDKCommonEvent "\":\"" kESDSDKEventSetTitle "\",\"" kESDSDKCommonPayload "\":{\"" kESDSDKPayloadTarget "\":");
+	outMessage.append(std::to_string(inTarget));
+	outMessage.append(",\"" kESDSDKPayloadTitle "\":");
+	AppendJSONString(outMessage, inTitle);
+	outMessage.append("}}");
+}
+
+void ESDConnectionManager::WriteSetImageMessage(std::string& outMessage, const char* inBase64Image, size_t inBase64ImageSize, const std::string& inContext, ESDSDKTarget inTarget)
+{
+	// {"context":"...","event":"setImage","payload":{"image":"data:image/png;base64,...","target":0}}
+	static const char prefix[] = "data:image/png;base64,";
+	static const size_t prefixLength = sizeof(prefix) - 1;
+	
+	outMessage.append("{\"" kESDSDKCommonContext "\":");
+	AppendJSONString(outMessage, inContext);
+	outMessage.append(",\"" kESDSDKCommonEvent "\":\"" kESDSDKEventSetImage "\",\"" kESDSDKCommonPayload "\":{\"" kESDSDKPayloadImage "\":");
+	if (inBase64ImageSize == 0 || (inBase64ImageSize >= prefixLength && std::memcmp(inBase64Image, prefix, prefixLength) == 0))
+	{
+		AppendJSONString(outMessage, inBase64Image, inBase64ImageSize);
+	}
 	else
-		payload[kESDSDKPayloadImage] = "data:image/png;base64," + inBase64ImageString;
-	jsonObject[kESDSDKCommonPayload] = payload;
+	{
+		// base64 data does not need to be escaped
+		outMessage.push_back('"');
+		outMessage.append(prefix, prefixLength);
+		outMessage.append(inBase64Image, inBase64ImageSize);
+		outMessage.push_back('"');
+	}
+	outMessage.append(",\"" kESDSDKPayloadTarget "\":");
+	outMessage.append(std::to_string(inTarget));
+	outMessage.append("}}");
+}
+
+void ESDConnectionManager::SetTitle(const std::string &inTitle, ESDStringID inContext, ESDSDKTarget inTarget)
+{
+	const std::string& context = ESDStringInterner::Get().GetString(inContext);
+	message_ptr message = GetMessageBuffer(inTitle.size() + context.size() + 80);
+	if (!message)
+		return;
 	
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	WriteSetTitleMessage(message->get_raw_payload(), inTitle, context, inTarget);
+	QueueKeyUpdate(inContext, false, message);
+}
+
+void ESDConnectionManager::SetImage(const std::string &inBase64ImageString, ESDStringID inContext, ESDSDKTarget inTarget)
+{
+	const std::string& context = ESDStringInterner::Get().GetString(inContext);
+	message_ptr message = GetMessageBuffer(inBase64ImageString.size() + context.size() + 120);
+	if (!message)
+		return;
+	
+	WriteSetImageMessage(message->get_raw_payload(), inBase64ImageString.data(), inBase64ImageString.size(), context, inTarget);
+	QueueKeyUpdate(inContext, true, message);
 }
 
-void ESDConnectionManager::ShowAlertForContext(const std::string& inContext)
+void ESDConnectionManager::SetKeys(const std::vector<ESDKeyChange>& inChanges)
+{
+	// Build all messages first, so the queue is locked only once
+	std::vector<message_ptr> messages;
+	messages.reserve(inChanges.size());
+	
+	const ESDStringInterner& interner = ESDStringInterner::Get();
+	for (const ESDKeyChange& change : inChanges)
+	{
+		message_ptr message;
+		if (!change.mPreparedImageId.empty())
+		{
+			std::lock_guard<std::mutex> lock(mPreparedImagesMutex);
+			auto it = mPreparedImages.find(GetPreparedImageKey(change.mContext, change.mTarget));
+			if (it != mPreparedImages.end() && it->second.mImageId == change.mPreparedImageId)
+				message = it->second.mMessage;
+			messages.push_back(message);
+			continue;
+		}
+		
+		const std::string& context = interner.GetString(change.mContext);
+		message = GetMessageBuffer(change.mValue.size() + context.size() + 120);
+		if (!message)
+			return;
+		
+		if (change.mIsImage)
+			WriteSetImageMessage(message->get_raw_payload(), change.mValue.data(), change.mValue.size(), context, change.mTarget);
+		else
+			WriteSetTitleMessage(message->get_raw_payload(), change.mValue, context, change.mTarget);
+		messages.push_back(message);
+	}
+	
+	bool scheduleFlush = false;
+	
+	{
+		std::lock_guard<std::mutex> lock(mPendingMutex);
+		for (size_t i = 0; i < inChanges.size(); i++)
+		{
+			// A prepared image that is missing is dropped
+			if (messages[i] && QueueKeyUpdateLocked(inChanges[i].mContext, inChanges[i].mIsImage || !inChanges[i].mPreparedImageId.empty(), messages[i]))
+				scheduleFlush = true;
+		}
+	}
+	
+	if (scheduleFlush)
+		ScheduleFlush();
+}
+
+void ESDConnectionManager::PrepareImage(const std::string& inImageId, const std::string &inBase64ImageString, ESDStringID inContext, ESDSDKTarget inTarget)
+{
+	PrepareImage(inImageId, inBase64ImageString.data(), inBase64ImageString.size(), inContext, inTarget);
+}
+
+void ESDConnectionManager::PrepareImage(const std::string& inImageId, const char* inBase64Image, size_t inBase64ImageSize, ESDStringID inContext, ESDSDKTarget inTarget)
+{
+	std::lock_guard<std::mutex> lock(mPreparedImagesMutex);
+	
+	PreparedImage& preparedImage = mPreparedImages[GetPreparedImageKey(inContext, inTarget)];
+	if (preparedImage.mImageId == inImageId && preparedImage.mMessage)
+		return;
+	
+	// Prepared messages live outside of the pool, websocketpp only reads them when sending
+	const std::string& context = ESDStringInterner::Get().GetString(inContext);
+	message_ptr message = websocketpp::lib::make_shared<ESDWebsocketConfig::message_type>(ESDWebsocketConfig::con_msg_manager_type::ptr(), websocketpp::frame::opcode::text, inBase64ImageSize + context.size() + 120);
+	message->set_compressed(true);
+	WriteSetImageMessage(message->get_raw_payload(), inBase64Image, inBase64ImageSize, context, inTarget);
+	
+	preparedImage.mImageId = inImageId;
+	preparedImage.mMessage = message;
+}
+
+bool ESDConnectionManager::SetPreparedImage(const std::string& inImageId, ESDStringID inContext, ESDSDKTarget inTarget)
+{
+	message_ptr message;
+	
+	{
+		std::lock_guard<std::mutex> lock(mPreparedImagesMutex);
+		auto it = mPreparedImages.find(GetPreparedImageKey(inContext, inTarget));
+		if (it == mPreparedImages.end() || it->second.mImageId != inImageId)
+			return false;
+		message = it->second.mMessage;
+	}
+	
+	QueueKeyUpdate(inContext, true, message);
+	return true;
+}
+
+void ESDConnectionManager::ShowAlertForContext(ESDStringID inContext)
 {
 	json jsonObject;
 
 	jsonObject[kESDSDKCommonEvent] = kESDSDKEventShowAlert;
-	jsonObject[kESDSDKCommonContext] = inContext;
+	jsonObject[kESDSDKCommonContext] = ESDStringInterner::Get().GetString(inContext);
 	
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	SendFrame(jsonObject.dump());
 }
 
-void ESDConnectionManager::ShowOKForContext(const std::string& inContext)
+void ESDConnectionManager::ShowOKForContext(ESDStringID inContext)
 {
 	json jsonObject;
 
 	jsonObject[kESDSDKCommonEvent] = kESDSDKEventShowOK;
-	jsonObject[kESDSDKCommonContext] = inContext;
+	jsonObject[kESDSDKCommonContext] = ESDStringInterner::Get().GetString(inContext);
 	
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	SendFrame(jsonObject.dump());
 }
 
-void ESDConnectionManager::SetSettings(const json &inSettings, const std::string& inContext)
+void ESDConnectionManager::SetSettings(const json &inSettings, ESDStringID inContext)
 {
 	json jsonObject;
 
 	jsonObject[kESDSDKCommonEvent] = kESDSDKEventSetSettings;
-	jsonObject[kESDSDKCommonContext] = inContext;
+	jsonObject[kESDSDKCommonContext] = ESDStringInterner::Get().GetString(inContext);
 	jsonObject[kESDSDKCommonPayload] = inSettings;
 	
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	SendFrame(jsonObject.dump());
 }
 
-void ESDConnectionManager::SetState(int inState, const std::string& inContext)
+void ESDConnectionManager::SetState(int inState, ESDStringID inContext)
 {
 	json jsonObject;
 	
@@ -253,35 +992,33 @@ void ESDConnectionManager::SetState(int inState, const std::string& inContext)
 	payload[kESDSDKPayloadState] = inState;
 
 	jsonObject[kESDSDKCommonEvent] = kESDSDKEventSetState;
-	jsonObject[kESDSDKCommonContext] = inContext;
+	jsonObject[kESDSDKCommonContext] = ESDStringInterner::Get().GetString(inContext);
 	jsonObject[kESDSDKCommonPayload] = payload;
 	
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	SendFrame(jsonObject.dump());
 }
 
-void ESDConnectionManager::SendToPropertyInspector(const std::string & inAction, const std::string & inContext, const json & inPayload)
+void ESDConnectionManager::SendToPropertyInspector(ESDStringID inAction, ESDStringID inContext, const json & inPayload)
 {
 	json jsonObject;
 
 	jsonObject[kESDSDKCommonEvent] = kESDSDKEventSendToPropertyInspector;
-	jsonObject[kESDSDKCommonContext] = inContext;
-	jsonObject[kESDSDKCommonAction] = inAction;
+	jsonObject[kESDSDKCommonContext] = ESDStringInterner::Get().GetString(inContext);
+	jsonObject[kESDSDKCommonAction] = ESDStringInterner::Get().GetString(inAction);
 	jsonObject[kESDSDKCommonPayload] = inPayload;
 
-	websocketpp::lib::error_code ec;
-	mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+	SendFrame(jsonObject.dump());
 }
 
-void ESDConnectionManager::SwitchToProfile(const std::string& inDeviceID, const std::string& inProfileName)
+void ESDConnectionManager::SwitchToProfile(ESDStringID inDeviceID, const std::string& inProfileName)
 {
-	if(!inDeviceID.empty())
+	if(inDeviceID != kESDNoStringID)
 	{
 		json jsonObject;
 
 		jsonObject[kESDSDKCommonEvent] = kESDSDKEventSwitchToProfile;
 		jsonObject[kESDSDKCommonContext] = mPluginUUID;
-		jsonObject[kESDSDKCommonDevice] = inDeviceID;
+		jsonObject[kESDSDKCommonDevice] = ESDStringInterner::Get().GetString(inDeviceID);
 		
 		if(!inProfileName.empty())
 		{
@@ -290,8 +1027,7 @@ void ESDConnectionManager::SwitchToProfile(const std::string& inDeviceID, const
 			jsonObject[kESDSDKCommonPayload] = payload;
 		}
 
-		websocketpp::lib::error_code ec;
-		mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+		SendFrame(jsonObject.dump());
 	}
 }
 
@@ -307,8 +1043,7 @@ void ESDConnectionManager::LogMessage(const std::string& inMessage)
 		payload[kESDSDKPayloadMessage] = inMessage;
 		jsonObject[kESDSDKCommonPayload] = payload;
 
-		websocketpp::lib::error_code ec;
-		mWebsocket.send(mConnectionHandle, jsonObject.dump(), websocketpp::frame::opcode::text, ec);
+		SendFrame(jsonObject.dump());
 	}
 }
 
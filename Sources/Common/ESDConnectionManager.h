@@ -13,17 +13,62 @@
 #pragma once
 
 #include "ESDBasePlugin.h"
+#include "ESDKeyRenderer.h"
 #include "ESDSDKDefines.h"
+#include "ESDMessagePool.h"
+#include "ESDPermessageDeflate.h"
+#include "ESDEventDecoder.h"
+#include "ESDLatencyHistogram.h"
 
 #include <websocketpp/config/asio_no_tls_client.hpp>
 #include <websocketpp/client.hpp>
 #include <websocketpp/common/thread.hpp>
 #include <websocketpp/common/memory.hpp>
 
-typedef websocketpp::config::asio_client::message_type::ptr message_ptr;
-typedef websocketpp::client<websocketpp::config::asio_client> WebsocketClient;
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
-class ESDConnectionManager
+// Client config using recycled message buffers and permessage-deflate
+struct ESDWebsocketConfig : public websocketpp::config::asio_client
+{
+	typedef ESDWebsocketConfig type;
+	typedef websocketpp::message_buffer::message<ESDMessagePool> message_type;
+	typedef ESDMessagePool<message_type> con_msg_manager_type;
+	typedef ESDMessagePoolManager<con_msg_manager_type> endpoint_msg_manager_type;
+	typedef ESDPermessageDeflate<permessage_deflate_config> permessage_deflate_type;
+};
+
+typedef ESDWebsocketConfig::message_type::ptr message_ptr;
+typedef websocketpp::client<ESDWebsocketConfig> WebsocketClient;
+
+// Counters of the outbound path, see ESDConnectionManager::GetSendStatistics()
+struct ESDSendStatistics
+{
+	// Bytes handed to the connection that are not written to the socket yet
+	size_t mBytesInFlight = 0;
+	// setTitle / setImage messages replaced by a newer one for the same context before they were sent
+	size_t mSupersededDrops = 0;
+	// Superseded messages dropped although another message was queued in between, only done above the high-water mark
+	size_t mBackpressureDrops = 0;
+	// Flushes postponed because the bytes in flight were above the high-water mark
+	size_t mDeferredFlushes = 0;
+	size_t mSendErrors = 0;
+	// Payload bytes of the sent messages before and after permessage-deflate, equal if the connection is not compressed
+	size_t mRawBytesSent = 0;
+	size_t mWireBytesSent = 0;
+	// The same for the setImage messages only
+	size_t mImageRawBytesSent = 0;
+	size_t mImageWireBytesSent = 0;
+};
+
+class ESDConnectionManager : public ESDKeyRenderer
 {
 public:
 	
@@ -34,19 +79,62 @@ public:
 		const std::string &inInfo,
 		ESDBasePlugin *inPlugin);
 	
-	// Start the event loop
+	// Start the event loop. Reconnects with exponential backoff when the connection drops and only
+	// returns once reconnecting failed kMaxReconnectAttempts times in a row.
 	void Run();
 	
-	// API to communicate with the Stream Deck application
-	void SetTitle(const std::string &inTitle, const std::string& inContext, ESDSDKTarget inTarget);
-	void SetImage(const std::string &inBase64ImageString, const std::string& inContext, ESDSDKTarget inTarget);
-	void ShowAlertForContext(const std::string& inContext);
-	void ShowOKForContext(const std::string& inContext);
-	void SetSettings(const json &inSettings, const std::string& inContext);
-	void SetState(int inState, const std::string& inContext);
-	void SendToPropertyInspector(const std::string& inAction, const std::string& inContext, const json &inPayload);
-	void SwitchToProfile(const std::string& inDeviceID, const std::string& inProfileName);
+	// Runs a handler on the strand of a device, after the events of the device that were already received.
+	// Handlers of the same device never run concurrently, handlers of different devices may.
+	void PostToDevice(ESDStringID inDeviceID, const std::function<void()>& inHandler);
+	
+	// Runs a handler on the strand of a device once the delay elapsed. The timers share the event workers,
+	// they need no thread of their own.
+	ESDTimerID StartTimer(ESDStringID inDeviceID, int inDelayMs, const std::function<void()>& inHandler) override;
+	// The handler of a cancelled timer is never called, even if the timer already expired. Does nothing
+	// if the handler already ran.
+	void CancelTimer(ESDTimerID inTimerID) override;
+	
+	// API to communicate with the Stream Deck application. The contexts and devices are the interned handles
+	// passed to the plugin, their strings are only looked up when the message is written.
+	void SetTitle(const std::string &inTitle, ESDStringID inContext, ESDSDKTarget inTarget);
+	void SetImage(const std::string &inBase64ImageString, ESDStringID inContext, ESDSDKTarget inTarget);
+	
+	// Changes several keys at once. The messages are queued together, so they go out back to back in the same flush
+	// and the keys change in the same frame instead of one after the other.
+	void SetKeys(const std::vector<ESDKeyChange>& inChanges) override;
+	
+	// Pre-render the setImage message of an image for a context, so it can later be sent with SetPreparedImage()
+	// without building the JSON again. Only the last prepared image is kept per context and target.
+	void PrepareImage(const std::string& inImageId, const std::string &inBase64ImageString, ESDStringID inContext, ESDSDKTarget inTarget);
+	void PrepareImage(const std::string& inImageId, const char* inBase64Image, size_t inBase64ImageSize, ESDStringID inContext, ESDSDKTarget inTarget);
+	// Returns false if the image has not been prepared for this context and target
+	bool SetPreparedImage(const std::string& inImageId, ESDStringID inContext, ESDSDKTarget inTarget);
+	
+	void ShowAlertForContext(ESDStringID inContext);
+	void ShowOKForContext(ESDStringID inContext);
+	void SetSettings(const json &inSettings, ESDStringID inContext);
+	void SetState(int inState, ESDStringID inContext);
+	void SendToPropertyInspector(ESDStringID inAction, ESDStringID inContext, const json &inPayload);
+	void SwitchToProfile(ESDStringID inDeviceID, const std::string& inProfileName);
 	void LogMessage(const std::string& inMessage);
+	
+	// While more bytes than the high-water mark are in flight, queued messages are held back so superseded
+	// key updates can be dropped instead of piling up in the connection
+	void SetSendHighWaterMark(size_t inBytes) { mSendHighWaterMark = inBytes; }
+	size_t GetBytesInFlight() const { return mBytesInFlight; }
+	ESDSendStatistics GetSendStatistics() const;
+	
+	// Time from the last connection drop until the keys were restored, 0 if the connection never dropped
+	size_t GetLastRecoveryTimeMs() const { return mLastRecoveryTimeMs; }
+	
+	// Latencies per event type, from the event arriving in OnMessage until its handler returned (dispatch)
+	// and until a message requested by the handler was handed to the socket (render).
+	// One line per event type with count, p50, p99 and max in microseconds.
+	std::string GetLatencyReport() const;
+	// Writes the report to the Stream Deck log
+	void LogLatencyReport();
+	// Writes the report to a local file, returns false if it could not be written
+	bool WriteLatencyReport(const std::string& inPath) const;
 
 private:
 	
@@ -55,6 +143,96 @@ private:
 	void OnFail(WebsocketClient * inClient, websocketpp::connection_hdl inConnectionHandler);
 	void OnClose(WebsocketClient * inClient, websocketpp::connection_hdl inConnectionHandler);
 	void OnMessage(websocketpp::connection_hdl, WebsocketClient::message_ptr inMsg);
+	void OnDisconnected();
+	void CheckCompressionNegotiation(const WebsocketClient::connection_ptr& inConnection);
+	
+	// Queues the last setTitle / setImage message of every context, replacing the queued key updates
+	void ReplayKeySnapshots();
+	// Only the keys that are visible are restored after a reconnect
+	void AddKeySnapshot(ESDStringID inContext, ESDStringID inDeviceID);
+	void RemoveKeySnapshot(ESDStringID inContext);
+	void RemoveKeySnapshotsOfDevice(ESDStringID inDeviceID);
+	
+	// The event whose handler requested an outbound message
+	struct EventOrigin
+	{
+		ESDSDKEventType mEventType = kESDSDKEventType_Unknown;
+		std::chrono::steady_clock::time_point mReceivedTime;
+	};
+	
+	// A decoded event, copied so the decoder can be reused while the event waits on its strand.
+	// The strings are interned right away, only the handles are passed on.
+	struct InboundEvent
+	{
+		ESDSDKEventType mEventType = kESDSDKEventType_Unknown;
+		std::chrono::steady_clock::time_point mReceivedTime;
+		ESDStringID mContext = kESDNoStringID;
+		ESDStringID mAction = kESDNoStringID;
+		ESDStringID mDeviceID = kESDNoStringID;
+		json mPayload;
+		json mDeviceInfo;
+	};
+	
+	// Calls the plugin handler of the event, runs on the strand of the device
+	void DispatchEvent(const InboundEvent& inEvent);
+	
+	// Returns the strand of the device, events without a device share one strand
+	websocketpp::lib::asio::io_service::strand& GetDeviceStrand(ESDStringID inDeviceID);
+	
+	void StartEventWorkers();
+	void StopEventWorkers();
+	
+	// Outbound queue. Messages can be queued from any thread, they are sent in order by the outbound strand
+	// on the network thread. setTitle / setImage messages are coalesced per context (last write wins) with
+	// the updates queued since the last other message.
+	void QueueKeyUpdate(ESDStringID inContext, bool inIsImage, const message_ptr& inMessage);
+	// Must be called with mPendingMutex locked, returns true if a flush has to be scheduled
+	bool QueueKeyUpdateLocked(ESDStringID inContext, bool inIsImage, const message_ptr& inMessage);
+	void QueueFrame(const message_ptr& inMessage);
+	void ScheduleFlush();
+	void FlushKeyUpdates();
+	void SendQueuedMessage(const message_ptr& inMessage, bool inIsImage, const EventOrigin& inOrigin);
+
+	void SendFrame(const std::string& inMessage);
+	
+	// Returns a recycled message buffer of the connection, nullptr if not connected.
+	// The message is compressed if permessage-deflate was negotiated.
+	message_ptr GetMessageBuffer(size_t inSizeHint);
+	
+	// Serialize the setTitle / setImage messages straight into a message buffer
+	static void WriteSetTitleMessage(std::string& outMessage, const std::string &inTitle, const std::string& inContext, ESDSDKTarget inTarget);
+	static void WriteSetImageMessage(std::string& outMessage, const char* inBase64Image, size_t inBase64ImageSize, const std::string& inContext, ESDSDKTarget inTarget);
+	
+	// The entries of the queue are reused.
+	// An entry either holds the key updates of a context or one other message.
+	struct PendingKeyUpdate
+	{
+		ESDStringID mContext = kESDNoStringID;
+		message_ptr mTitleMessage;
+		message_ptr mImageMessage;
+		message_ptr mFrameMessage;
+		EventOrigin mTitleOrigin;
+		EventOrigin mImageOrigin;
+		EventOrigin mFrameOrigin;
+	};
+	
+	// Last title and image sent or queued for a key that appeared. The payloads are copied, the messages
+	// themselves go back to the pool once they were sent.
+	struct KeySnapshot
+	{
+		ESDStringID mDeviceID = kESDNoStringID;
+		std::string mTitlePayload;
+		std::string mImagePayload;
+	};
+	
+	struct PreparedImage
+	{
+		std::string mImageId;
+		message_ptr mMessage;
+	};
+	
+	// The prepared images are kept per context and target
+	static uint64_t GetPreparedImageKey(ESDStringID inContext, ESDSDKTarget inTarget) { return ((uint64_t)inContext << 32) | (uint32_t)inTarget; }
 	
 	// Member variables
 	int mPort = 0;
@@ -63,5 +241,76 @@ private:
 	websocketpp::connection_hdl mConnectionHandle;
 	WebsocketClient mWebsocket;
 	ESDBasePlugin * mPlugin = nullptr;
+	ESDEventDecoder mEventDecoder;
+	
+	WebsocketClient::connection_ptr mConnection;
+	
+	// Number of threads running the handlers of inbound events
+	static const size_t kEventWorkerCount = 2;
+	
+	websocketpp::lib::asio::io_service mEventWorkerService;
+	std::unique_ptr<websocketpp::lib::asio::io_service::work> mEventWorkerWork;
+	std::vector<std::thread> mEventWorkers;
+	std::mutex mDeviceStrandsMutex;
+	std::unordered_map<ESDStringID, std::unique_ptr<websocketpp::lib::asio::io_service::strand>> mDeviceStrands;
+	
+	// Running timers, a timer is removed when its handler runs or when it is cancelled
+	std::mutex mTimersMutex;
+	std::map<ESDTimerID, std::shared_ptr<websocketpp::lib::asio::steady_timer>> mTimers;
+	ESDTimerID mLastTimerID = 0;
+	
+	std::unique_ptr<websocketpp::lib::asio::io_service::strand> mOutboundStrand;
+	
+	std::mutex mPendingMutex;
+	std::vector<PendingKeyUpdate> mPendingKeyUpdates;
+	size_t mPendingKeyUpdateCount = 0;
+	// Key updates are only coalesced with the entries after the last other message
+	size_t mPendingCoalesceStart = 0;
+	bool mFlushScheduled = false;
+	
+	// Guarded by mPendingMutex
+	std::unordered_map<ESDStringID, KeySnapshot> mKeySnapshots;
+	
+	// Only used by the outbound strand
+	std::vector<PendingKeyUpdate> mFlushingKeyUpdates;
+	std::unique_ptr<websocketpp::lib::asio::steady_timer> mFlushRetryTimer;
+	bool mFlushRetryPending = false;
+	
+	// Default high-water mark, about a dozen key images
+	static const size_t kDefaultSendHighWaterMark = 512 * 1024;
+	// Time after which a flush held back by the high-water mark is retried
+	static const int kFlushRetryIntervalMs = 10;
+	
+	std::atomic<size_t> mSendHighWaterMark { kDefaultSendHighWaterMark };
+	std::atomic<size_t> mBytesInFlight { 0 };
+	std::atomic<bool> mSendBackpressure { false };
+	std::atomic<size_t> mSupersededDrops { 0 };
+	std::atomic<size_t> mBackpressureDrops { 0 };
+	std::atomic<size_t> mDeferredFlushes { 0 };
+	std::atomic<size_t> mSendErrors { 0 };
+	std::atomic<size_t> mRawBytesSent { 0 };
+	std::atomic<size_t> mWireBytesSent { 0 };
+	std::atomic<size_t> mImageRawBytesSent { 0 };
+	std::atomic<size_t> mImageWireBytesSent { 0 };
+	
+	static const int kReconnectInitialDelayMs = 100;
+	static const int kReconnectMaxDelayMs = 5000;
+	static const int kMaxReconnectAttempts = 10;
+	
+	// Only used by the network thread
+	int mReconnectAttempts = 0;
+	bool mWasConnected = false;
+	bool mRecoveryPending = false;
+	std::chrono::steady_clock::time_point mDisconnectTime;
+	std::atomic<size_t> mLastRecoveryTimeMs { 0 };
+	
+	// The event handled by the calling thread, unknown outside of the event handlers
+	static thread_local EventOrigin sCurrentEventOrigin;
+	
+	ESDLatencyHistogram mDispatchLatencies[kESDSDKEventType_Count];
+	ESDLatencyHistogram mRenderLatencies[kESDSDKEventType_Count];
+	
+	std::mutex mPreparedImagesMutex;
+	std::unordered_map<uint64_t, PreparedImage> mPreparedImages;
 };
 
@@ -0,0 +1,236 @@
+//==============================================================================
+/**
+@file       ESDEventDecoder.cpp
+
+@brief      Single pass decoder for the events sent by the Stream Deck application
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "ESDEventDecoder.h"
+#include "ESDBasePlugin.h"
+#include "ESDSDKDefines.h"
+
+
+bool ESDEventDecoder::Decode(const std::string& inMessage, ESDBasePlugin* inPlugin)
+{
+	mEvent.clear();
+	mEventType = kESDSDKEventType_Unknown;
+	mContext.clear();
+	mAction.clear();
+	mDeviceID.clear();
+	mPayload = nullptr;
+	mDeviceInfo = nullptr;
+
+	mPlugin = inPlugin;
+	mDepth = 0;
+	mCurrentField = Field::None;
+	mBuildStack.clear();
+	mStoppedEarly = false;
+
+	if (!json::sax_parse(inMessage, this) && !mStoppedEarly)
+		return false;
+
+	// The payload was built before the event was known
+	if (!mPayload.is_null() && !WantsPayload())
+		mPayload = nullptr;
+
+	return true;
+}
+
+bool ESDEventDecoder::WantsPayload() const
+{
+	return mPlugin == nullptr || mPlugin->NeedsPayloadForEvent(mEventType);
+}
+
+bool ESDEventDecoder::AddValue(json&& inValue)
+{
+	if (mBuildStack.empty())
+		return false;
+
+	json* container = mBuildStack.back();
+	if (container->is_array())
+		container->push_back(std::move(inValue));
+	else
+		(*container)[mBuildKey] = std::move(inValue);
+	return true;
+}
+
+bool ESDEventDecoder::StartContainer(json&& inValue)
+{
+	mDepth++;
+
+	if (!mBuildStack.empty())
+	{
+		json* container = mBuildStack.back();
+		if (container->is_array())
+		{
+			container->push_back(std::move(inValue));
+			mBuildStack.push_back(&container->back());
+		}
+		else
+		{
+			json& element = (*container)[mBuildKey];
+			element = std::move(inValue);
+			mBuildStack.push_back(&element);
+		}
+	}
+	else if (mDepth == 2 && inValue.is_object())
+	{
+		// Only objects are accepted for payload and deviceInfo
+		if (mCurrentField == Field::Payload && (mEvent.empty() || WantsPayload()))
+		{
+			mPayload = std::move(inValue);
+			mBuildStack.push_back(&mPayload);
+		}
+		else if (mCurrentField == Field::DeviceInfo)
+		{
+			mDeviceInfo = std::move(inValue);
+			mBuildStack.push_back(&mDeviceInfo);
+		}
+	}
+
+	return true;
+}
+
+bool ESDEventDecoder::EndContainer()
+{
+	mDepth--;
+
+	if (!mBuildStack.empty())
+		mBuildStack.pop_back();
+
+	if (mDepth == 1)
+		mCurrentField = Field::None;
+
+	return true;
+}
+
+bool ESDEventDecoder::null()
+{
+	AddValue(nullptr);
+	return true;
+}
+
+bool ESDEventDecoder::boolean(bool inValue)
+{
+	AddValue(inValue);
+	return true;
+}
+
+bool ESDEventDecoder::number_integer(number_integer_t inValue)
+{
+	AddValue(inValue);
+	return true;
+}
+
+bool ESDEventDecoder::number_unsigned(number_unsigned_t inValue)
+{
+	AddValue(inValue);
+	return true;
+}
+
+bool ESDEventDecoder::number_float(number_float_t inValue, const string_t& /*inString*/)
+{
+	AddValue(inValue);
+	return true;
+}
+
+bool ESDEventDecoder::string(string_t& inValue)
+{
+	if (!mBuildStack.empty())
+	{
+		AddValue(std::move(inValue));
+	}
+	else if (mDepth == 1)
+	{
+		switch (mCurrentField)
+		{
+			case Field::Event:
+				mEvent.swap(inValue);
+				mEventType = ESDSDKGetEventType(mEvent);
+				break;
+			case Field::Context:	mContext.swap(inValue); break;
+			case Field::Action:		mAction.swap(inValue); break;
+			case Field::Device:		mDeviceID.swap(inValue); break;
+			default: break;
+		}
+	}
+
+	return true;
+}
+
+bool ESDEventDecoder::start_object(std::size_t /*inElements*/)
+{
+	// The message itself
+	if (mDepth == 0)
+	{
+		mDepth++;
+		return true;
+	}
+
+	return StartContainer(json::object());
+}
+
+bool ESDEventDecoder::key(string_t& inValue)
+{
+	if (!mBuildStack.empty())
+	{
+		mBuildKey.swap(inValue);
+	}
+	else if (mDepth == 1)
+	{
+		if (inValue == kESDSDKCommonEvent)
+			mCurrentField = Field::Event;
+		else if (inValue == kESDSDKCommonContext)
+			mCurrentField = Field::Context;
+		else if (inValue == kESDSDKCommonAction)
+			mCurrentField = Field::Action;
+		else if (inValue == kESDSDKCommonDevice)
+			mCurrentField = Field::Device;
+		else if (inValue == kESDSDKCommonPayload)
+		{
+			mCurrentField = Field::Payload;
+
+			// Nothing left to decode if the payload is skipped anyway, stop parsing
+			if (!mEvent.empty() && !mContext.empty() && !mAction.empty() && !mDeviceID.empty() && !WantsPayload())
+			{
+				mStoppedEarly = true;
+				return false;
+			}
+		}
+		else if (inValue == kESDSDKCommonDeviceInfo)
+			mCurrentField = Field::DeviceInfo;
+		else
+			mCurrentField = Field::None;
+	}
+
+	return true;
+}
+
+bool ESDEventDecoder::end_object()
+{
+	return EndContainer();
+}
+
+bool ESDEventDecoder::start_array(std::size_t /*inElements*/)
+{
+	// A message has to be an object
+	if (mDepth == 0)
+		return false;
+
+	return StartContainer(json::array());
+}
+
+bool ESDEventDecoder::end_array()
+{
+	return EndContainer();
+}
+
+bool ESDEventDecoder::parse_error(std::size_t /*inPosition*/, const std::string& /*inLastToken*/, const nlohmann::detail::exception& /*inException*/)
+{
+	return false;
+}
@@ -0,0 +1,88 @@
+//==============================================================================
+/**
+@file       ESDEventDecoder.h
+
+@brief      Single pass decoder for the events sent by the Stream Deck application
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "EPLJSONUtils.h"
+#include "ESDSDKEvents.h"
+
+class ESDBasePlugin;
+
+// SAX handler extracting event, context, action and device of an inbound message in one pass.
+// The payload is only turned into a json object if the plugin asks for it, the deviceInfo of
+// deviceDidConnect events is always kept. The decoder reuses its buffers between messages.
+class ESDEventDecoder : public nlohmann::json_sax<json>
+{
+public:
+
+	// Decodes the message, returns false if it is not a valid JSON object
+	bool Decode(const std::string& inMessage, ESDBasePlugin* inPlugin);
+
+	const std::string& GetEvent() const { return mEvent; }
+	ESDSDKEventType GetEventType() const { return mEventType; }
+	const std::string& GetContext() const { return mContext; }
+	const std::string& GetAction() const { return mAction; }
+	const std::string& GetDeviceID() const { return mDeviceID; }
+	const json& GetPayload() const { return mPayload; }
+	const json& GetDeviceInfo() const { return mDeviceInfo; }
+
+	// json_sax interface
+	bool null() override;
+	bool boolean(bool inValue) override;
+	bool number_integer(number_integer_t inValue) override;
+	bool number_unsigned(number_unsigned_t inValue) override;
+	bool number_float(number_float_t inValue, const string_t& inString) override;
+	bool string(string_t& inValue) override;
+	bool start_object(std::size_t inElements) override;
+	bool key(string_t& inValue) override;
+	bool end_object() override;
+	bool start_array(std::size_t inElements) override;
+	bool end_array() override;
+	bool parse_error(std::size_t inPosition, const std::string& inLastToken, const nlohmann::detail::exception& inException) override;
+
+private:
+
+	enum class Field
+	{
+		None,
+		Event,
+		Context,
+		Action,
+		Device,
+		Payload,
+		DeviceInfo
+	};
+
+	bool WantsPayload() const;
+
+	// Adds a value to the json object currently being built, returns false if the value is skipped
+	bool AddValue(json&& inValue);
+	bool StartContainer(json&& inValue);
+	bool EndContainer();
+
+	std::string mEvent;
+	ESDSDKEventType mEventType = kESDSDKEventType_Unknown;
+	std::string mContext;
+	std::string mAction;
+	std::string mDeviceID;
+	json mPayload;
+	json mDeviceInfo;
+
+	ESDBasePlugin* mPlugin = nullptr;
+	int mDepth = 0;
+	Field mCurrentField = Field::None;
+	bool mStoppedEarly = false;
+
+	// Containers of the json object currently being built, empty if the current value is skipped
+	std::vector<json*> mBuildStack;
+	std::string mBuildKey;
+};
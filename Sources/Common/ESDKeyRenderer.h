@@ -0,0 +1,58 @@
+//==============================================================================
+/**
+@file       ESDKeyRenderer.h
+
+@brief      Interface to change the keys of a device and to run timers for it
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "ESDSDKDefines.h"
+#include "ESDStringInterner.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Identifies a timer started with ESDKeyRenderer::StartTimer(), 0 is never used
+typedef uint64_t ESDTimerID;
+
+// A title or image change of one key, see ESDKeyRenderer::SetKeys()
+struct ESDKeyChange
+{
+	ESDStringID mContext = kESDNoStringID;
+	bool mIsImage = false;
+	// The title, or the base64 encoded image
+	std::string mValue;
+	// If set, the image prepared for the key under this id is displayed instead of mValue.
+	// The change is dropped if no such image was prepared.
+	std::string mPreparedImageId;
+	ESDSDKTarget mTarget = kESDSDKTarget_HardwareAndSoftware;
+};
+
+// What the code driving the keys needs from the connection: batched key changes and timers on the strand
+// of the device. ESDConnectionManager implements it for the Stream Deck application, code written against
+// this interface, like the animations, can also run without a connection and on a virtual clock.
+class ESDKeyRenderer
+{
+public:
+
+	virtual ~ESDKeyRenderer() { }
+
+	// Runs a handler on the strand of a device once the delay elapsed
+	virtual ESDTimerID StartTimer(ESDStringID inDeviceID, int inDelayMs, const std::function<void()>& inHandler) = 0;
+	// The handler of a cancelled timer is never called
+	virtual void CancelTimer(ESDTimerID inTimerID) = 0;
+
+	// Changes several keys at once, so they change in the same frame
+	virtual void SetKeys(const std::vector<ESDKeyChange>& inChanges) = 0;
+
+	// The clock the timers run on
+	virtual std::chrono::steady_clock::time_point GetTime() const { return std::chrono::steady_clock::now(); }
+};
@@ -0,0 +1,99 @@
+//==============================================================================
+/**
+@file       ESDLatencyHistogram.h
+
+@brief      Fixed-bucket latency histogram
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free histogram of durations in microseconds. Each power of two is split into 4 buckets, so a
+// percentile is reported with an error of at most 25%, from 1 us up to about a minute. Values above
+// the last bucket are counted in it. The maximum is exact.
+class ESDLatencyHistogram
+{
+public:
+
+	ESDLatencyHistogram()
+	{
+		for (std::atomic<uint64_t>& bucket : mBuckets)
+			bucket = 0;
+	}
+
+	void Record(uint64_t inMicroseconds)
+	{
+		mBuckets[GetBucket(inMicroseconds)].fetch_add(1, std::memory_order_relaxed);
+		mCount.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t max = mMax.load(std::memory_order_relaxed);
+		while (inMicroseconds > max && !mMax.compare_exchange_weak(max, inMicroseconds, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint64_t GetCount() const { return mCount.load(std::memory_order_relaxed); }
+	uint64_t GetMax() const { return mMax.load(std::memory_order_relaxed); }
+
+	// Returns the upper bound of the bucket holding the percentile (0-100), 0 if nothing was recorded
+	uint64_t GetPercentile(double inPercentile) const
+	{
+		uint64_t count = GetCount();
+		if (count == 0)
+			return 0;
+
+		uint64_t rank = (uint64_t)(inPercentile / 100.0 * (double)count + 0.5);
+		rank = std::max<uint64_t>(1, std::min(rank, count));
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < kBucketCount; i++)
+		{
+			seen += mBuckets[i].load(std::memory_order_relaxed);
+			if (seen >= rank)
+				return std::min(GetBucketUpperBound(i), GetMax());
+		}
+		return GetMax();
+	}
+
+private:
+
+	static const size_t kSubBuckets = 4;
+	static const size_t kBucketCount = 100;
+
+	static size_t GetBucket(uint64_t inMicroseconds)
+	{
+		if (inMicroseconds < kSubBuckets)
+			return (size_t)inMicroseconds;
+
+		// Shift the value to [kSubBuckets, 2 * kSubBuckets), the shift selects the power of two
+		size_t exponent = 0;
+		while (inMicroseconds >= 2 * kSubBuckets)
+		{
+			inMicroseconds >>= 1;
+			exponent++;
+		}
+		return std::min(kSubBuckets + exponent * kSubBuckets + (size_t)(inMicroseconds - kSubBuckets), kBucketCount - 1);
+	}
+
+	static uint64_t GetBucketUpperBound(size_t inBucket)
+	{
+		if (inBucket < kSubBuckets)
+			return inBucket;
+
+		size_t exponent = (inBucket - kSubBuckets) / kSubBuckets;
+		uint64_t mantissa = (inBucket - kSubBuckets) % kSubBuckets + kSubBuckets;
+		return ((mantissa + 1) << exponent) - 1;
+	}
+
+	std::atomic<uint64_t> mBuckets[kBucketCount];
+	std::atomic<uint64_t> mCount { 0 };
+	std::atomic<uint64_t> mMax { 0 };
+};
@@ -13,6 +13,7 @@
 #include "ESDLocalizer.h"
 #include "ESDUtilities.h"
 #include "EPLJSONUtils.h"
+#include "ESDResourcePack.h"
 #include <fstream>
 
 static ESDLocalizer* sLocalizer = nullptr;
@@ -29,6 +30,15 @@ ESDLocalizer::ESDLocalizer(const std::string &inLanguageCode)
 {
 	try
 	{
+		// The strings of the resource pack are looked up in place
+		const char* table = nullptr;
+		size_t tableSize = 0;
+		if (!inLanguageCode.empty() && ESDResourcePack::Get().GetResource(inLanguageCode + ".json", table, tableSize))
+		{
+			mPackTableName = inLanguageCode + ".json";
+			return;
+		}
+		
 		std::string pluginPath = ESDUtilities::GetPluginPath();
 		if (!inLanguageCode.empty() && !pluginPath.empty())
 		{
@@ -59,5 +69,13 @@ std::string ESDLocalizer::GetLocalizedString(const std::string &inDefaultString)
 
 std::string ESDLocalizer::GetLocalizedStringIntern(const std::string &inDefaultString)
 {
+	if (!mPackTableName.empty())
+	{
+		std::string localizedString;
+		if (ESDResourcePack::Get().GetTableString(mPackTableName, inDefaultString, localizedString))
+			return localizedString;
+		return inDefaultString;
+	}
+	
 	return EPLJSONUtils::GetStringByName(mLocalizationData, inDefaultString, inDefaultString);
 }
@@ -24,6 +24,8 @@ private:
 	ESDLocalizer(const std::string &inLanguageCode);
 	std::string GetLocalizedStringIntern(const std::string &inDefaultString);
 
+	// Name of the localization table in the resource pack, empty if the strings are read from the loose file
+	std::string mPackTableName;
 	json mLocalizationData;
 };
 
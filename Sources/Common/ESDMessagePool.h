@@ -0,0 +1,114 @@
+//==============================================================================
+/**
+@file       ESDMessagePool.h
+
+@brief      Recycling message buffer manager for the websocket connection
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <websocketpp/common/memory.hpp>
+#include <websocketpp/frame.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Connection message manager that keeps the messages it created and hands them out again
+// once websocketpp released them. The payload strings keep their capacity, so once the pool
+// is warmed up, sending and receiving does not allocate message buffers anymore.
+// Drop-in replacement for websocketpp::message_buffer::alloc::con_msg_manager.
+template <typename message>
+class ESDMessagePool : public websocketpp::lib::enable_shared_from_this<ESDMessagePool<message>>
+{
+public:
+	typedef ESDMessagePool<message> type;
+	typedef websocketpp::lib::shared_ptr<type> ptr;
+	typedef websocketpp::lib::weak_ptr<type> weak_ptr;
+	typedef typename message::ptr message_ptr;
+
+	// Maximum number of messages kept in the pool. Messages requested while all of them are
+	// in use are allocated and freed as usual.
+	static const size_t kMaxPooledMessages = 64;
+
+	message_ptr get_message()
+	{
+		return AcquireMessage(websocketpp::frame::opcode::text, 0);
+	}
+
+	message_ptr get_message(websocketpp::frame::opcode::value inOpcode, size_t inSize)
+	{
+		return AcquireMessage(inOpcode, inSize);
+	}
+
+	// Messages are owned by shared pointers, websocketpp never calls this
+	bool recycle(message *)
+	{
+		return false;
+	}
+
+	// Number of message buffers allocated since the start of the process
+	static size_t GetAllocationCount() { return sAllocationCount; }
+
+private:
+
+	message_ptr AcquireMessage(websocketpp::frame::opcode::value inOpcode, size_t inSize)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// A message only referenced by the pool is not used by websocketpp anymore
+		for (size_t i = 0; i < mMessages.size(); i++)
+		{
+			message_ptr& candidate = mMessages[mNextIndex];
+			mNextIndex = (mNextIndex + 1) % mMessages.size();
+
+			if (candidate.use_count() == 1)
+			{
+				candidate->set_opcode(inOpcode);
+				candidate->set_prepared(false);
+				candidate->set_fin(true);
+				candidate->set_terminal(false);
+				candidate->set_compressed(false);
+				candidate->set_header(std::string());
+				candidate->get_raw_payload().clear();
+				candidate->get_raw_payload().reserve(inSize);
+				return candidate;
+			}
+		}
+
+		sAllocationCount++;
+		message_ptr newMessage = websocketpp::lib::make_shared<message>(type::shared_from_this(), inOpcode, inSize);
+		if (mMessages.size() < kMaxPooledMessages)
+		{
+			mMessages.push_back(newMessage);
+		}
+		return newMessage;
+	}
+
+	std::mutex mMutex;
+	std::vector<message_ptr> mMessages;
+	size_t mNextIndex = 0;
+
+	static std::atomic<size_t> sAllocationCount;
+};
+
+template <typename message>
+std::atomic<size_t> ESDMessagePool<message>::sAllocationCount(0);
+
+// Endpoint message manager creating one pool per connection
+template <typename con_msg_manager>
+class ESDMessagePoolManager
+{
+public:
+	typedef typename con_msg_manager::ptr con_msg_man_ptr;
+
+	con_msg_man_ptr get_manager() const
+	{
+		return websocketpp::lib::make_shared<con_msg_manager>();
+	}
+};
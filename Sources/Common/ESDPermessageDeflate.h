@@ -0,0 +1,79 @@
+//==============================================================================
+/**
+@file       ESDPermessageDeflate.h
+
+@brief      permessage-deflate extension used by the websocket connection
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+// Compression needs zlib, which is part of the macOS SDK. Define ESD_PERMESSAGE_DEFLATE to 1
+// on other platforms once zlib is linked.
+#ifndef ESD_PERMESSAGE_DEFLATE
+	#ifdef __APPLE__
+		#define ESD_PERMESSAGE_DEFLATE 1
+	#else
+		#define ESD_PERMESSAGE_DEFLATE 0
+	#endif
+#endif
+
+#include <atomic>
+#include <sstream>
+#include <string>
+
+#if ESD_PERMESSAGE_DEFLATE
+
+// The default client config includes disabled.hpp, which does not compile after enabled.hpp
+#include <websocketpp/extensions/permessage_deflate/disabled.hpp>
+#include <websocketpp/http/constants.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+
+// permessage-deflate with the settings of the plugin. The outbound messages keep the compression
+// context between messages, so the envelopes of the setTitle / setImage messages, which repeat the
+// same contexts and event names, are mostly back-references. The window stays at its maximum of 15 bits.
+// If the server declines the offer, the connection is simply not compressed.
+template <typename config>
+class ESDPermessageDeflate : public websocketpp::extensions::permessage_deflate::enabled<config>
+{
+public:
+
+	// Replaces the offer of websocketpp, which always asks for client_no_context_takeover
+	std::string generate_offer() const
+	{
+		if (!sOffered)
+			return std::string();
+		return "permessage-deflate; client_max_window_bits";
+	}
+
+	// Called when the server failed the negotiation, so the next connection is opened without compression
+	static void SetOffered(bool inOffered) { sOffered = inOffered; }
+	static bool IsOffered() { return sOffered; }
+
+private:
+
+	static std::atomic<bool> sOffered;
+};
+
+template <typename config>
+std::atomic<bool> ESDPermessageDeflate<config>::sOffered(true);
+
+#else
+
+#include <websocketpp/extensions/permessage_deflate/disabled.hpp>
+
+// Stand-in used when zlib is not available, never offers compression
+template <typename config>
+class ESDPermessageDeflate : public websocketpp::extensions::permessage_deflate::disabled<config>
+{
+public:
+
+	static void SetOffered(bool /*inOffered*/) { }
+	static bool IsOffered() { return false; }
+};
+
+#endif
@@ -0,0 +1,160 @@
+//==============================================================================
+/**
+@file       ESDResourcePack.cpp
+
+@brief      Read-only access to the resources packed into resources.pack
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "ESDResourcePack.h"
+#include "ESDUtilities.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const char kPackMagic[8] = { 'E', 'S', 'D', 'P', 'A', 'C', 'K', '\0' };
+static const uint32_t kPackVersion = 1;
+static const size_t kHeaderSize = 16;
+static const size_t kEntrySize = 16;
+
+// Compares a key with a string stored in the pack, in the byte order used by the pack
+static int CompareKey(const std::string& inKey, const char* inString, size_t inSize)
+{
+	int result = std::memcmp(inKey.data(), inString, std::min(inKey.size(), inSize));
+	if (result != 0)
+		return result;
+	if (inKey.size() == inSize)
+		return 0;
+	return inKey.size() < inSize ? -1 : 1;
+}
+
+const ESDResourcePack& ESDResourcePack::Get()
+{
+	// Mapped by the first caller, the other threads wait until it is mapped
+	static const ESDResourcePack sResourcePack(ESDUtilities::AddPathComponent(ESDUtilities::GetPluginPath(), kESDResourcePackFileName));
+	return sResourcePack;
+}
+
+ESDResourcePack::ESDResourcePack(const std::string& inPath)
+{
+	mData = ESDUtilities::MapFile(inPath, mSize);
+	if (mData == nullptr)
+		return;
+	
+	if (mSize < kHeaderSize || std::memcmp(mData, kPackMagic, sizeof(kPackMagic)) != 0 || ReadUInt32(8) != kPackVersion)
+	{
+		DebugPrint("Invalid resource pack %s\n", inPath.c_str());
+		ESDUtilities::UnmapFile(mData, mSize);
+		mData = nullptr;
+		return;
+	}
+	
+	mEntryCount = ReadUInt32(12);
+	if (!IsValid())
+	{
+		DebugPrint("Corrupt resource pack %s\n", inPath.c_str());
+		ESDUtilities::UnmapFile(mData, mSize);
+		mData = nullptr;
+		mEntryCount = 0;
+	}
+}
+
+ESDResourcePack::~ESDResourcePack()
+{
+	ESDUtilities::UnmapFile(mData, mSize);
+}
+
+uint32_t ESDResourcePack::ReadUInt32(size_t inOffset) const
+{
+	// The pack is little-endian, like all platforms of the plugin
+	uint32_t value = 0;
+	std::memcpy(&value, mData + inOffset, sizeof(value));
+	return value;
+}
+
+bool ESDResourcePack::IsValid() const
+{
+	if ((mSize - kHeaderSize) / kEntrySize < mEntryCount)
+		return false;
+	
+	for (uint32_t i = 0; i < mEntryCount; i++)
+	{
+		size_t entry = kHeaderSize + i * kEntrySize;
+		uint32_t nameOffset = ReadUInt32(entry);
+		uint32_t nameSize = ReadUInt32(entry + 4);
+		uint32_t dataOffset = ReadUInt32(entry + 8);
+		uint32_t dataSize = ReadUInt32(entry + 12);
+		if (nameOffset > mSize || nameSize > mSize - nameOffset || dataOffset > mSize || dataSize > mSize - dataOffset)
+			return false;
+	}
+	
+	return true;
+}
+
+bool ESDResourcePack::GetResource(const std::string& inName, const char*& outData, size_t& outSize) const
+{
+	// Binary search in the sorted entries
+	size_t first = 0;
+	size_t last = mEntryCount;
+	while (first < last)
+	{
+		size_t middle = first + (last - first) / 2;
+		size_t entry = kHeaderSize + middle * kEntrySize;
+		int result = CompareKey(inName, mData + ReadUInt32(entry), ReadUInt32(entry + 4));
+		if (result == 0)
+		{
+			outData = mData + ReadUInt32(entry + 8);
+			outSize = ReadUInt32(entry + 12);
+			return true;
+		}
+		
+		if (result < 0)
+			last = middle;
+		else
+			first = middle + 1;
+	}
+	
+	return false;
+}
+
+bool ESDResourcePack::GetTableString(const std::string& inTableName, const std::string& inKey, std::string& outValue) const
+{
+	const char* table = nullptr;
+	size_t tableSize = 0;
+	if (!GetResource(inTableName, table, tableSize) || tableSize < 4)
+		return false;
+	
+	uint32_t count = 0;
+	std::memcpy(&count, table, sizeof(count));
+	if ((tableSize - 4) / kEntrySize < count)
+		return false;
+	
+	size_t first = 0;
+	size_t last = count;
+	while (first < last)
+	{
+		size_t middle = first + (last - first) / 2;
+		uint32_t string[4];
+		std::memcpy(string, table + 4 + middle * kEntrySize, sizeof(string));
+		if (string[0] > tableSize || string[1] > tableSize - string[0] || string[2] > tableSize || string[3] > tableSize - string[2])
+			return false;
+		
+		int result = CompareKey(inKey, table + string[0], string[1]);
+		if (result == 0)
+		{
+			outValue.assign(table + string[2], string[3]);
+			return true;
+		}
+		
+		if (result < 0)
+			last = middle;
+		else
+			first = middle + 1;
+	}
+	
+	return false;
+}
@@ -0,0 +1,62 @@
+//==============================================================================
+/**
+@file       ESDResourcePack.h
+
+@brief      Read-only access to the resources packed into resources.pack
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// File name of the pack in the plugin folder, built by Tools/PackResources.py
+#define kESDResourcePackFileName "resources.pack"
+
+// The resources of the plugin packed into one file, which is mapped into memory once and read in place.
+// The PNG files are stored base64 encoded, the localization files as tables of the strings of their
+// "Localization" object. If the plugin has no valid pack, IsOpen() is false and the resources have to be
+// read from the loose files.
+//
+// Format, all integers are 32 bit little-endian and all offsets are from the start of the file:
+//   "ESDPACK\0", version, entry count
+//   per entry, sorted by name: name offset, name size, data offset, data size
+//   names and data
+// A table is: count, then per string sorted by key: key offset, key size, value offset, value size,
+// the offsets are from the start of the table.
+class ESDResourcePack
+{
+public:
+
+	// Maps the pack of the plugin on the first call
+	static const ESDResourcePack& Get();
+
+	bool IsOpen() const { return mData != nullptr; }
+
+	// Finds a resource by its file name. The data stays valid until the process exits.
+	bool GetResource(const std::string& inName, const char*& outData, size_t& outSize) const;
+	// Looks up a string in a table resource, i.e. a localization file
+	bool GetTableString(const std::string& inTableName, const std::string& inKey, std::string& outValue) const;
+
+private:
+
+	ESDResourcePack(const std::string& inPath);
+	~ESDResourcePack();
+
+	ESDResourcePack(const ESDResourcePack&) = delete;
+	ESDResourcePack& operator=(const ESDResourcePack&) = delete;
+
+	// Checks that all entries lie within the file
+	bool IsValid() const;
+
+	uint32_t ReadUInt32(size_t inOffset) const;
+
+	const char* mData = nullptr;
+	size_t mSize = 0;
+	uint32_t mEntryCount = 0;
+};
@@ -0,0 +1,111 @@
+//==============================================================================
+/**
+@file       ESDSDKEvents.h
+
+@brief      Typed identifiers for the events sent by the Stream Deck application
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "ESDSDKDefines.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+typedef int ESDSDKEventType;
+enum
+{
+	kESDSDKEventType_Unknown = 0,
+	kESDSDKEventType_KeyDown,
+	kESDSDKEventType_KeyUp,
+	kESDSDKEventType_WillAppear,
+	kESDSDKEventType_WillDisappear,
+	kESDSDKEventType_DeviceDidConnect,
+	kESDSDKEventType_DeviceDidDisconnect,
+	kESDSDKEventType_ApplicationDidLaunch,
+	kESDSDKEventType_ApplicationDidTerminate,
+	kESDSDKEventType_SystemDidWakeUp,
+	kESDSDKEventType_TitleParametersDidChange,
+	kESDSDKEventType_DidReceiveSettings,
+	kESDSDKEventType_DidReceiveGlobalSettings,
+	kESDSDKEventType_PropertyInspectorDidAppear,
+	kESDSDKEventType_PropertyInspectorDidDisappear,
+	kESDSDKEventType_SendToPlugin,
+	kESDSDKEventType_Count
+};
+
+
+// FNV-1a hash, evaluated at compile time for the event names so they can be used as case labels.
+// Two event names with the same hash would be duplicate case labels and fail to compile.
+constexpr uint32_t ESDSDKEventHash(const char *inString, size_t inLength)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < inLength; i++)
+	{
+		hash ^= static_cast<uint8_t>(inString[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+#define ESDSDK_EVENT_TYPE_CASE(inName, inType) \
+	case ESDSDKEventHash(inName, sizeof(inName) - 1): \
+		return inEvent.size() == sizeof(inName) - 1 && std::memcmp(inEvent.data(), inName, sizeof(inName) - 1) == 0 ? inType : kESDSDKEventType_Unknown;
+
+// Returns the type of an inbound event with one hash and one string comparison
+inline ESDSDKEventType ESDSDKGetEventType(const std::string &inEvent)
+{
+	switch (ESDSDKEventHash(inEvent.data(), inEvent.size()))
+	{
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventKeyDown, kESDSDKEventType_KeyDown)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventKeyUp, kESDSDKEventType_KeyUp)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventWillAppear, kESDSDKEventType_WillAppear)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventWillDisappear, kESDSDKEventType_WillDisappear)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventDeviceDidConnect, kESDSDKEventType_DeviceDidConnect)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventDeviceDidDisconnect, kESDSDKEventType_DeviceDidDisconnect)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventApplicationDidLaunch, kESDSDKEventType_ApplicationDidLaunch)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventApplicationDidTerminate, kESDSDKEventType_ApplicationDidTerminate)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventSystemDidWakeUp, kESDSDKEventType_SystemDidWakeUp)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventTitleParametersDidChange, kESDSDKEventType_TitleParametersDidChange)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventDidReceiveSettings, kESDSDKEventType_DidReceiveSettings)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventDidReceiveGlobalSettings, kESDSDKEventType_DidReceiveGlobalSettings)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventPropertyInspectorDidAppear, kESDSDKEventType_PropertyInspectorDidAppear)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventPropertyInspectorDidDisappear, kESDSDKEventType_PropertyInspectorDidDisappear)
+		ESDSDK_EVENT_TYPE_CASE(kESDSDKEventSendToPlugin, kESDSDKEventType_SendToPlugin)
+		default:
+			return kESDSDKEventType_Unknown;
+	}
+}
+
+#undef ESDSDK_EVENT_TYPE_CASE
+
+// Returns the event name of a type, an empty string for kESDSDKEventType_Unknown
+inline const char* ESDSDKGetEventName(ESDSDKEventType inEventType)
+{
+	switch (inEventType)
+	{
+		case kESDSDKEventType_KeyDown:							return kESDSDKEventKeyDown;
+		case kESDSDKEventType_KeyUp:							return kESDSDKEventKeyUp;
+		case kESDSDKEventType_WillAppear:						return kESDSDKEventWillAppear;
+		case kESDSDKEventType_WillDisappear:					return kESDSDKEventWillDisappear;
+		case kESDSDKEventType_DeviceDidConnect:					return kESDSDKEventDeviceDidConnect;
+		case kESDSDKEventType_DeviceDidDisconnect:				return kESDSDKEventDeviceDidDisconnect;
+		case kESDSDKEventType_ApplicationDidLaunch:				return kESDSDKEventApplicationDidLaunch;
+		case kESDSDKEventType_ApplicationDidTerminate:			return kESDSDKEventApplicationDidTerminate;
+		case kESDSDKEventType_SystemDidWakeUp:					return kESDSDKEventSystemDidWakeUp;
+		case kESDSDKEventType_TitleParametersDidChange:			return kESDSDKEventTitleParametersDidChange;
+		case kESDSDKEventType_DidReceiveSettings:				return kESDSDKEventDidReceiveSettings;
+		case kESDSDKEventType_DidReceiveGlobalSettings:			return kESDSDKEventDidReceiveGlobalSettings;
+		case kESDSDKEventType_PropertyInspectorDidAppear:		return kESDSDKEventPropertyInspectorDidAppear;
+		case kESDSDKEventType_PropertyInspectorDidDisappear:	return kESDSDKEventPropertyInspectorDidDisappear;
+		case kESDSDKEventType_SendToPlugin:						return kESDSDKEventSendToPlugin;
+		default:												return "";
+	}
+}
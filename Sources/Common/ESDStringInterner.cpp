@@ -0,0 +1,122 @@
+//==============================================================================
+/**
+@file       ESDStringInterner.cpp
+
+@brief      Maps the context, device and action strings to small integer handles
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "ESDStringInterner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+ESDStringInterner& ESDStringInterner::Get()
+{
+	static ESDStringInterner sInterner;
+	return sInterner;
+}
+
+ESDStringInterner::ESDStringInterner()
+{
+	for (std::atomic<std::string*>& chunk : mChunks)
+		chunk.store(nullptr, std::memory_order_relaxed);
+
+	// The empty string is always kESDNoStringID
+	std::string* firstChunk = new std::string[kFirstChunkSize];
+	mChunks[0].store(firstChunk, std::memory_order_release);
+	mIDs.emplace(Key { firstChunk[0].data(), 0 }, kESDNoStringID);
+	mCount.store(1, std::memory_order_release);
+}
+
+ESDStringInterner::~ESDStringInterner()
+{
+	for (std::atomic<std::string*>& chunk : mChunks)
+		delete[] chunk.load(std::memory_order_relaxed);
+}
+
+size_t ESDStringInterner::KeyHash::operator()(const Key& inKey) const
+{
+	// The contexts and devices are 32 hex digits, so mix 8 bytes at a time
+	uint64_t hash = 0x9E3779B97F4A7C15ULL ^ inKey.mSize;
+	size_t offset = 0;
+	while (offset < inKey.mSize)
+	{
+		uint64_t word = 0;
+		std::memcpy(&word, inKey.mData + offset, std::min<size_t>(8, inKey.mSize - offset));
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 32;
+		offset += 8;
+	}
+	return (size_t)hash;
+}
+
+size_t ESDStringInterner::GetChunkIndex(size_t inIndex)
+{
+	// Chunk n starts at kFirstChunkSize * (2^n - 1)
+	size_t chunkIndex = 0;
+	for (size_t start = inIndex / kFirstChunkSize + 1; start > 1; start >>= 1)
+		chunkIndex++;
+	return chunkIndex;
+}
+
+bool ESDStringInterner::KeyEqual::operator()(const Key& inLhs, const Key& inRhs) const
+{
+	return inLhs.mSize == inRhs.mSize && std::memcmp(inLhs.mData, inRhs.mData, inLhs.mSize) == 0;
+}
+
+ESDStringID ESDStringInterner::Intern(const std::string& inString)
+{
+	return Intern(inString.data(), inString.size());
+}
+
+ESDStringID ESDStringInterner::Intern(const char* inString, size_t inSize)
+{
+	if (inSize == 0)
+		return kESDNoStringID;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mIDs.find(Key { inString, inSize });
+	if (it != mIDs.end())
+		return it->second;
+
+	// Folding a new string into kESDNoStringID would make its action invalid, so running out of handles is an error
+	size_t index = mCount.load(std::memory_order_relaxed);
+	size_t chunkIndex = GetChunkIndex(index);
+	if (chunkIndex >= kMaxChunkCount)
+		throw std::length_error("ESDStringInterner: out of string handles");
+
+	std::string* chunk = mChunks[chunkIndex].load(std::memory_order_relaxed);
+	if (chunk == nullptr)
+	{
+		chunk = new std::string[kFirstChunkSize << chunkIndex];
+		mChunks[chunkIndex].store(chunk, std::memory_order_release);
+	}
+
+	// The stored string is the key of the map, it never moves
+	std::string& string = chunk[index - GetChunkStart(chunkIndex)];
+	string.assign(inString, inSize);
+	ESDStringID id = (ESDStringID)index;
+	mIDs.emplace(Key { string.data(), string.size() }, id);
+	mCount.store(index + 1, std::memory_order_release);
+	return id;
+}
+
+const std::string& ESDStringInterner::GetString(ESDStringID inID) const
+{
+	static const std::string sEmptyString;
+
+	// A handle is only passed on after Intern() returned it, so its string is complete
+	if (inID >= mCount.load(std::memory_order_acquire))
+		return sEmptyString;
+
+	size_t chunkIndex = GetChunkIndex(inID);
+	const std::string* chunk = mChunks[chunkIndex].load(std::memory_order_acquire);
+	return chunk[inID - GetChunkStart(chunkIndex)];
+}
@@ -0,0 +1,90 @@
+//==============================================================================
+/**
+@file       ESDStringInterner.h
+
+@brief      Maps the context, device and action strings to small integer handles
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Handle of an interned string. Equal strings get the same handle, so handles are compared and hashed
+// instead of the strings. The handles are dense, starting with kESDNoStringID for the empty string.
+typedef uint32_t ESDStringID;
+static const ESDStringID kESDNoStringID = 0;
+
+// Immutable list of handles, shared instead of copied
+typedef std::vector<ESDStringID> ESDStringIDList;
+typedef std::shared_ptr<const ESDStringIDList> ESDStringIDListPtr;
+
+// Interns the strings of the inbound events once, the plugin then only works with the handles and the
+// strings are looked up again when an outbound message is written.
+// The strings are never released: every distinct string seen since the start of the process stays interned,
+// about 150 bytes for a context with its map entry. The Stream Deck application creates new contexts when
+// profiles are switched, so a long running plugin keeps growing slowly, about 5 KB per new XL profile. The table
+// grows with it until the handles run out after about 4 billion strings, Intern() then throws.
+class ESDStringInterner
+{
+public:
+
+	static ESDStringInterner& Get();
+
+	// Returns the handle of the string, interning it if it is new
+	ESDStringID Intern(const std::string& inString);
+	ESDStringID Intern(const char* inString, size_t inSize);
+
+	// Lock-free. The string stays valid until the process exits.
+	const std::string& GetString(ESDStringID inID) const;
+
+	// Number of interned strings, including the empty string
+	size_t GetCount() const { return mCount.load(std::memory_order_acquire); }
+
+private:
+
+	ESDStringInterner();
+	~ESDStringInterner();
+
+	ESDStringInterner(const ESDStringInterner&) = delete;
+	ESDStringInterner& operator=(const ESDStringInterner&) = delete;
+
+	// Key of the map, pointing to the stored string or to the string looked up
+	struct Key
+	{
+		const char* mData;
+		size_t mSize;
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key& inKey) const;
+	};
+	struct KeyEqual
+	{
+		bool operator()(const Key& inLhs, const Key& inRhs) const;
+	};
+
+	// The strings are stored in chunks that are never moved, so GetString() does not need the lock. Each chunk
+	// is twice as large as the one before, kMaxChunkCount chunks hold as many strings as there are handles.
+	static const size_t kFirstChunkSize = 128;
+	static const size_t kMaxChunkCount = 25;
+
+	// The chunk holding the string of a handle, and the index of the first handle in a chunk
+	static size_t GetChunkIndex(size_t inIndex);
+	static size_t GetChunkStart(size_t inChunkIndex) { return kFirstChunkSize * (((size_t)1 << inChunkIndex) - 1); }
+
+	std::mutex mMutex;
+	std::unordered_map<Key, ESDStringID, KeyHash, KeyEqual> mIDs;
+	std::atomic<std::string*> mChunks[kMaxChunkCount];
+	std::atomic<size_t> mCount { 0 };
+};
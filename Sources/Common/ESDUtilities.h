@@ -28,5 +28,9 @@ public:
 	
 	// Get the path of the .sdPlugin bundle
 	static std::string GetPluginPath();
+	
+	// Map a file read-only into memory. Returns nullptr if the file does not exist or could not be mapped.
+	static const char* MapFile(const std::string& inPath, size_t& outSize);
+	static void UnmapFile(const char* inData, size_t inSize);
 };
 
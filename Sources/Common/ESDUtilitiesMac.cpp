@@ -12,6 +12,10 @@
 
 #include "ESDUtilities.h"
 #include <CoreFoundation/CoreFoundation.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 static std::string CFStringGetStdString(CFStringRef inStringRef, CFStringEncoding inEncoding)
@@ -186,3 +190,33 @@ std::string ESDUtilities::GetPluginPath()
 	return sPluginPath;
 }
 
+const char* ESDUtilities::MapFile(const std::string& inPath, size_t& outSize)
+{
+	outSize = 0;
+	
+	int file = open(inPath.c_str(), O_RDONLY);
+	if (file < 0)
+		return nullptr;
+	
+	const char* data = nullptr;
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+	{
+		// The mapping stays valid after the file is closed
+		void* mapping = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping != MAP_FAILED)
+		{
+			data = static_cast<const char*>(mapping);
+			outSize = (size_t)fileStatus.st_size;
+		}
+	}
+	
+	close(file);
+	return data;
+}
+
+void ESDUtilities::UnmapFile(const char* inData, size_t inSize)
+{
+	if (inData != nullptr)
+		munmap(const_cast<char*>(inData), inSize);
+}
@@ -276,3 +276,36 @@ std::string ESDUtilities::GetPluginPath()
 
 	return sPluginPath;
 }
+
+const char* ESDUtilities::MapFile(const std::string& inPath, size_t& outSize)
+{
+	outSize = 0;
+	
+	HANDLE file = CreateFileA(inPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	
+	const char* data = nullptr;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		// The view stays valid after both handles are closed
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data != nullptr)
+				outSize = (size_t)fileSize.QuadPart;
+			CloseHandle(mapping);
+		}
+	}
+	
+	CloseHandle(file);
+	return data;
+}
+
+void ESDUtilities::UnmapFile(const char* inData, size_t inSize)
+{
+	if (inData != nullptr)
+		UnmapViewOfFile(inData);
+}
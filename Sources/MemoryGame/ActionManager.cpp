@@ -11,53 +11,56 @@
 //==============================================================================
 
 #include "ActionManager.h"
-#include "../MyStreamDeckPlugin.h"
 
-ActionManager::ActionManager(MyStreamDeckPlugin* inMemoryGamePlugin)
+#include <algorithm>
+
+ActionManager::ActionManager(ActionManagerListener* inListener)
 {
-	mMemoryGamePlugin = inMemoryGamePlugin;
+	mListener = inListener;
+	mRegistry = std::make_shared<const Registry>();
 }
 
 ActionManager::~ActionManager()
 {
 }
 
-std::vector<StreamDeckAction> ActionManager::GetAllActions()
+std::shared_ptr<const ActionManager::Registry> ActionManager::GetRegistry() const
 {
-	std::vector<StreamDeckAction> allActions;
-	mMutex.lock();
-	for (auto actionGroup : mActionsByDeviceId)
-		allActions.insert(--allActions.end(), actionGroup.second.begin(), actionGroup.second.end());
-	mMutex.unlock();
-	return allActions;
+	return std::atomic_load(&mRegistry);
 }
 
-std::vector<StreamDeckAction> ActionManager::GetAllGameActionsForDevice(const std::string& inDeviceId)
+DeviceSnapshotPtr ActionManager::FindDeviceSnapshot(const Registry& inRegistry, ESDStringID inDeviceId)
 {
-	mMutex.lock();
-	std::vector<StreamDeckAction> ret;
-	if (mActionsByDeviceId.find(inDeviceId) != mActionsByDeviceId.end())
-		ret = std::vector<StreamDeckAction>(mActionsByDeviceId[inDeviceId].begin(), mActionsByDeviceId[inDeviceId].end());
+	for (const DeviceSnapshotPtr& snapshot : inRegistry)
+	{
+		if (snapshot->mDeviceId == inDeviceId)
+			return snapshot;
+	}
+	return nullptr;
+}
 
-	mMutex.unlock();
-	return ret;
+DeviceSnapshotPtr ActionManager::GetDeviceSnapshot(ESDStringID inDeviceId) const
+{
+	return FindDeviceSnapshot(*GetRegistry(), inDeviceId);
 }
 
-bool ActionManager::IsDeviceOnline(const std::string& inDeviceId)
+ESDStringIDListPtr ActionManager::GetContextsForDevice(ESDStringID inDeviceId, ESDStringID inActionType) const
 {
-	mMutex.lock();
-	bool knownDevice = mActiveDevicesById.find(inDeviceId) != mActiveDevicesById.end();
-	mMutex.unlock();
-	return knownDevice;
+	static const ESDStringIDListPtr sNoContexts = std::make_shared<const ESDStringIDList>();
+	
+	DeviceSnapshotPtr snapshot = GetDeviceSnapshot(inDeviceId);
+	if (!snapshot)
+		return sNoContexts;
+	auto contexts = snapshot->mContextsByType.find(inActionType);
+	return contexts != snapshot->mContextsByType.end() ? contexts->second : sNoContexts;
 }
 
-StreamDeckDevice ActionManager::GetDeviceInfoForId(const std::string& inDeviceId) 
+ESDStringID ActionManager::GetDeviceIdForContext(ESDStringID inContext)
 {
-	mMutex.lock();
-	auto it = mActiveDevicesById.find(inDeviceId);
-	StreamDeckDevice device = it != mActiveDevicesById.end() ? it->second : StreamDeckDevice("", -1, -1);
-	mMutex.unlock();
-	return device;
+	// Only needed for the rare sendToPlugin events, so it is not worth a lock-free index
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto action = mActionsByContext.find(inContext);
+	return action != mActionsByContext.end() ? action->second.mDeviceId : kESDNoStringID;
 }
 
 void ActionManager::AddDevice(const StreamDeckDevice& inDevice)
@@ -65,22 +68,22 @@ void ActionManager::AddDevice(const StreamDeckDevice& inDevice)
 	if (!inDevice.IsValid())
 		return;
 	mMutex.lock();
-	bool newDevice = mActiveDevicesById.find(inDevice.mDeviceId) == mActiveDevicesById.end();
+	bool newDevice = mActiveDevicesById.insert(std::make_pair(inDevice.mDeviceId, inDevice)).second;
 	if (newDevice)
-		mActiveDevicesById[inDevice.mDeviceId] = inDevice;
+		PublishDeviceLocked(inDevice.mDeviceId);
+	bool isComplete = newDevice && IsCompleteProfileLoaded(inDevice.mDeviceId);
 	mMutex.unlock();
-	if (newDevice && IsCompleteProfileLoaded(inDevice.mDeviceId) && mMemoryGamePlugin != nullptr)
+	if (isComplete && mListener != nullptr)
 	{
-		mMemoryGamePlugin->ProfileLoadedForDevice(inDevice.mDeviceId);
+		mListener->ProfileLoadedForDevice(inDevice.mDeviceId);
 	}
 }
 
-void ActionManager::RemoveDevice(const std::string& inDeviceId)
+void ActionManager::RemoveDevice(ESDStringID inDeviceId)
 {
 	mMutex.lock();
-	bool isKnownDevice = mActiveDevicesById.find(inDeviceId) != mActiveDevicesById.end();
-	if (isKnownDevice)
-		mActiveDevicesById.erase(inDeviceId);
+	if (mActiveDevicesById.erase(inDeviceId) != 0)
+		PublishDeviceLocked(inDeviceId);
 	mMutex.unlock();
 }
 
@@ -88,49 +91,115 @@ void ActionManager::AddAction(const StreamDeckAction& inAction)
 {
 	if (!inAction.IsValid())
 		return;
-	bool updateDevice = false;
 	mMutex.lock();
-	if (mActionsByDeviceId.find(inAction.mDeviceId) == mActionsByDeviceId.end()) 
+	auto existing = mActionsByContext.find(inAction.mContext);
+	bool updateDevice = existing == mActionsByContext.end() || !(existing->second == inAction);
+	if (updateDevice)
 	{
-		mActionsByDeviceId[inAction.mDeviceId] = std::set<StreamDeckAction>({ inAction });
-		updateDevice = true;
-	}
-	else
-	{
-		updateDevice = mActionsByDeviceId[inAction.mDeviceId].find(inAction) == mActionsByDeviceId[inAction.mDeviceId].end();
-		mActionsByDeviceId[inAction.mDeviceId].insert(inAction);
+		// A context that changed its device or type only counts for the new one
+		if (existing != mActionsByContext.end())
+			RemoveActionLocked(StreamDeckAction(existing->second));
+		mActionsByContext.insert(std::make_pair(inAction.mContext, inAction));
+		PublishActionLocked(inAction, true);
 	}
+	bool isComplete = updateDevice && IsCompleteProfileLoaded(inAction.mDeviceId);
 	mMutex.unlock();
-	if (updateDevice && IsCompleteProfileLoaded(inAction.mDeviceId) && mMemoryGamePlugin != nullptr)
-		mMemoryGamePlugin->ProfileLoadedForDevice(inAction.mDeviceId);
+	if (isComplete && mListener != nullptr)
+		mListener->ProfileLoadedForDevice(inAction.mDeviceId);
 }
 
 void ActionManager::RemoveAction(const StreamDeckAction& inAction)
 {
 	if (!inAction.IsValid())
 		return;
-	bool isInUse = IsDeviceOnline(inAction.mDeviceId);
 	mMutex.lock();
-	if (mActionsByDeviceId.find(inAction.mDeviceId) != mActionsByDeviceId.end())
-	{
-		mActionsByDeviceId[inAction.mDeviceId].erase(inAction);
-		isInUse = isInUse && true;
-	}
+	bool isInUse = mActiveDevicesById.find(inAction.mDeviceId) != mActiveDevicesById.end();
+	auto existing = mActionsByContext.find(inAction.mContext);
+	if (existing != mActionsByContext.end() && existing->second == inAction)
+		RemoveActionLocked(inAction);
 	mMutex.unlock();
 	if (isInUse)
 		ActionOfActiveDeviceDisappeared(inAction.mDeviceId, inAction.mContext);
 }
 
-bool ActionManager::IsCompleteProfileLoaded(const std::string& inDeviceId)
+bool ActionManager::IsCompleteProfileLoaded(ESDStringID inDeviceId)
 {
-	auto device = GetDeviceInfoForId(inDeviceId);
-	auto actions = GetAllGameActionsForDevice(inDeviceId);
-	return device.Size() == actions.size();
+	// An unknown device has size 0 and no actions
+	DeviceSnapshotPtr snapshot = GetDeviceSnapshot(inDeviceId);
+	if (!snapshot)
+		return true;
+	return (size_t)snapshot->mDevice.Size() == snapshot->mActionCount;
 }
 
+void ActionManager::RemoveActionLocked(const StreamDeckAction& inAction)
+{
+	mActionsByContext.erase(inAction.mContext);
+	PublishActionLocked(inAction, false);
+}
+
+void ActionManager::PublishDeviceLocked(ESDStringID inDeviceId)
+{
+	DeviceSnapshotPtr current = GetDeviceSnapshot(inDeviceId);
+	std::shared_ptr<DeviceSnapshot> snapshot = current ? std::make_shared<DeviceSnapshot>(*current) : std::make_shared<DeviceSnapshot>();
+	snapshot->mDeviceId = inDeviceId;
+	
+	auto device = mActiveDevicesById.find(inDeviceId);
+	snapshot->mDevice = device != mActiveDevicesById.end() ? device->second : StreamDeckDevice();
+	PublishSnapshotLocked(inDeviceId, snapshot);
+}
+
+void ActionManager::PublishActionLocked(const StreamDeckAction& inAction, bool inAppeared)
+{
+	DeviceSnapshotPtr current = GetDeviceSnapshot(inAction.mDeviceId);
+	std::shared_ptr<DeviceSnapshot> snapshot = current ? std::make_shared<DeviceSnapshot>(*current) : std::make_shared<DeviceSnapshot>();
+	snapshot->mDeviceId = inAction.mDeviceId;
+	
+	// Only the list of the type of the action is copied
+	ESDStringIDListPtr& contexts = snapshot->mContextsByType[inAction.mActionType];
+	std::shared_ptr<ESDStringIDList> newContexts = contexts ? std::make_shared<ESDStringIDList>(*contexts) : std::make_shared<ESDStringIDList>();
+	if (inAppeared)
+	{
+		newContexts->push_back(inAction.mContext);
+		snapshot->mActionCount++;
+	}
+	else
+	{
+		auto context = std::find(newContexts->begin(), newContexts->end(), inAction.mContext);
+		if (context != newContexts->end())
+		{
+			newContexts->erase(context);
+			snapshot->mActionCount--;
+		}
+	}
+	
+	if (newContexts->empty())
+		snapshot->mContextsByType.erase(inAction.mActionType);
+	else
+		contexts = newContexts;
+	PublishSnapshotLocked(inAction.mDeviceId, snapshot);
+}
+
+void ActionManager::PublishSnapshotLocked(ESDStringID inDeviceId, const std::shared_ptr<DeviceSnapshot>& inSnapshot)
+{
+	// The snapshots of the other devices are shared with the current registry
+	std::shared_ptr<const Registry> current = GetRegistry();
+	std::shared_ptr<Registry> registry = std::make_shared<Registry>();
+	registry->reserve(current->size() + 1);
+	for (const DeviceSnapshotPtr& snapshot : *current)
+	{
+		if (snapshot->mDeviceId != inDeviceId)
+			registry->push_back(snapshot);
+	}
+	
+	// A device that is neither connected nor has actions is forgotten
+	if (inSnapshot->mDevice.IsValid() || inSnapshot->mActionCount != 0)
+		registry->push_back(inSnapshot);
+	
+	std::atomic_store(&mRegistry, std::shared_ptr<const Registry>(registry));
+}
 
-void ActionManager::ActionOfActiveDeviceDisappeared(const std::string& inDeviceId, const std::string& inContext) 
+void ActionManager::ActionOfActiveDeviceDisappeared(ESDStringID inDeviceId, ESDStringID inContext) 
 {
-	if (mMemoryGamePlugin != nullptr)
-		mMemoryGamePlugin->ActionOfActiveDeviceDisappeared(inDeviceId, inContext);
+	if (mListener != nullptr)
+		mListener->ActionOfActiveDeviceDisappeared(inDeviceId, inContext);
 }
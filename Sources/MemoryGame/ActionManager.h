@@ -12,35 +12,67 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include "../Common/EPLJSONUtils.h"
 #include "StreamDeckAction.h"
 #include "StreamDeckDevice.h"
 
-class MyStreamDeckPlugin;
+// Notified by the ActionManager to start and stop the games, implemented by MyStreamDeckPlugin
+class ActionManagerListener
+{
+public:
+
+	virtual ~ActionManagerListener() { }
+
+	// All actions of a connected device appeared
+	virtual void ProfileLoadedForDevice(ESDStringID inDeviceId) = 0;
+	// An action of a connected device disappeared
+	virtual void ActionOfActiveDeviceDisappeared(ESDStringID inDeviceId, ESDStringID inContext) = 0;
+};
+
+// Immutable state of one device. A change of the device or of its actions publishes a new snapshot,
+// so a reader can keep using the one it got for as long as it holds it.
+struct DeviceSnapshot
+{
+	ESDStringID mDeviceId = kESDNoStringID;
+	// Invalid while the device is not connected
+	StreamDeckDevice mDevice;
+	// Number of appeared actions of all types
+	size_t mActionCount = 0;
+	// The contexts partitioned by action type, in the order they appeared. A change only rebuilds the list of its type,
+	// the other lists are shared with the previous snapshot.
+	std::unordered_map<ESDStringID, ESDStringIDListPtr> mContextsByType;
+};
+
+typedef std::shared_ptr<const DeviceSnapshot> DeviceSnapshotPtr;
 
 // Class to manage actions and devices. Notifies the plugin if the game can be started, or has to be stopped.
+// The writers serialize on a mutex and publish the registry as snapshots. The readers never take that mutex,
+// they only copy the registry pointer with std::atomic_load(). This is not lock-free everywhere: libstdc++ and
+// the MSVC STL guard atomic shared_ptr operations with internal locks held for the pointer copy, so readers
+// can still briefly contend with each other and with the store of a writer.
 class ActionManager
 {
 public:
 
-	ActionManager(MyStreamDeckPlugin* inMemoryGamePlugin);
+	ActionManager(ActionManagerListener* inListener);
 	~ActionManager();	
 
-	// Methods for accessing the appeared actions
-	std::vector<StreamDeckAction> GetAllActions();
-	std::vector<StreamDeckAction> GetAllGameActionsForDevice(const std::string& inDeviceId);
+	// The current snapshot of the device, nullptr if neither the device nor any of its actions appeared
+	DeviceSnapshotPtr GetDeviceSnapshot(ESDStringID inDeviceId) const;
+	// The contexts of the actions of a type on the device, never nullptr. The list is not copied.
+	ESDStringIDListPtr GetContextsForDevice(ESDStringID inDeviceId, ESDStringID inActionType) const;
 
-	bool IsDeviceOnline(const std::string& inDeviceId);
-
-	// Returns the device data stored for device. If the device id is unknown, returns an invalid device
-	StreamDeckDevice GetDeviceInfoForId(const std::string& inDeviceId);
+	// Returns the device of an appeared action, kESDNoStringID if the context is unknown
+	ESDStringID GetDeviceIdForContext(ESDStringID inContext);
 
 	// Method to add devices. If all the actions have already appeared, it notifies the plugin
 	void AddDevice(const StreamDeckDevice& inDevice);
 
 	// Method to remove devices
-	void RemoveDevice(const std::string& inDeviceId);
+	void RemoveDevice(ESDStringID inDeviceId);
 
 	// Method to add actions. If the actions belongs to a connected device and all actions for this device appeared, it notifies the plugin
 	void AddAction(const StreamDeckAction&  inAction);
@@ -49,18 +81,39 @@ public:
 	void RemoveAction(const StreamDeckAction& inAction);
 
 	// Returns true if the number of appeared actions for device equals the devices' size.
-	bool IsCompleteProfileLoaded(const std::string& inDeviceId);
+	// Compares the counts of the snapshot, does not copy or allocate.
+	bool IsCompleteProfileLoaded(ESDStringID inDeviceId);
 
 private:
 
-	// Signals the plugin that a possibly used context disappeared
-	void ActionOfActiveDeviceDisappeared(const std::string& inDeviceId, const std::string& inContext);
+	// One snapshot per device, there are only a few devices
+	typedef std::vector<DeviceSnapshotPtr> Registry;
+
+	std::shared_ptr<const Registry> GetRegistry() const;
+	static DeviceSnapshotPtr FindDeviceSnapshot(const Registry& inRegistry, ESDStringID inDeviceId);
+
+	// The methods below must be called with mMutex locked
+
+	// Remove the action from the context index and the snapshot of its device
+	void RemoveActionLocked(const StreamDeckAction& inAction);
+
+	// Derive the next snapshot of the device from the current one and publish the registry with it
+	void PublishDeviceLocked(ESDStringID inDeviceId);
+	void PublishActionLocked(const StreamDeckAction& inAction, bool inAppeared);
+	void PublishSnapshotLocked(ESDStringID inDeviceId, const std::shared_ptr<DeviceSnapshot>& inSnapshot);
+
+	// Signals the listener that a possibly used context disappeared
+	void ActionOfActiveDeviceDisappeared(ESDStringID inDeviceId, ESDStringID inContext);
 
 	std::mutex mMutex;
-	MyStreamDeckPlugin* mMemoryGamePlugin = nullptr;
+	ActionManagerListener* mListener = nullptr;
 
-	std::map<std::string, StreamDeckDevice>				mActiveDevicesById;
-	std::map<std::string, std::set<StreamDeckAction>>	mActionsByDeviceId;
+	std::unordered_map<ESDStringID, StreamDeckDevice>	mActiveDevicesById;
+	// Every appeared action by its context, a context belongs to one action
+	std::unordered_map<ESDStringID, StreamDeckAction>	mActionsByContext;
 
-};
+	// Published registry, only accessed with std::atomic_load() and std::atomic_store(). The snapshots of the
+	// devices that did not change are shared with the previous registry.
+	std::shared_ptr<const Registry>						mRegistry;
 
+};
@@ -0,0 +1,75 @@
+//==============================================================================
+/**
+@file       GameRandom.h
+
+@brief      Small and fast random number generator for dealing the games
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+
+// xoshiro256** seeded with splitmix64. Each game owns one, so the games never share state across threads,
+// and a game dealt with the same seed gets the same board.
+class GameRandom
+{
+public:
+
+	explicit GameRandom(uint64_t inSeed = 0) { Seed(inSeed); }
+
+	void Seed(uint64_t inSeed)
+	{
+		for (uint64_t& state : mState)
+		{
+			inSeed += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = inSeed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			state = z ^ (z >> 31);
+		}
+	}
+
+	uint64_t Next()
+	{
+		const uint64_t result = RotateLeft(mState[1] * 5, 7) * 9;
+		const uint64_t t = mState[1] << 17;
+		mState[2] ^= mState[0];
+		mState[3] ^= mState[1];
+		mState[1] ^= mState[2];
+		mState[0] ^= mState[3];
+		mState[2] ^= t;
+		mState[3] = RotateLeft(mState[3], 45);
+		return result;
+	}
+
+	// Uniform in [0, inBound) without modulo bias (Lemire's multiply and reject), inBound must not be 0
+	uint32_t NextBelow(uint32_t inBound)
+	{
+		uint64_t product = (Next() >> 32) * inBound;
+		uint32_t low = (uint32_t)product;
+		if (low < inBound)
+		{
+			const uint32_t threshold = (0u - inBound) % inBound;
+			while (low < threshold)
+			{
+				product = (Next() >> 32) * inBound;
+				low = (uint32_t)product;
+			}
+		}
+		return (uint32_t)(product >> 32);
+	}
+
+private:
+
+	static uint64_t RotateLeft(uint64_t inValue, int inShift)
+	{
+		return (inValue << inShift) | (inValue >> (64 - inShift));
+	}
+
+	uint64_t mState[4];
+};
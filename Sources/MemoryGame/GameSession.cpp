@@ -0,0 +1,111 @@
+//==============================================================================
+/**
+@file       GameSession.cpp
+
+@brief      Record of the deals and key presses of a game, to replay it
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "GameSession.h"
+
+#include <fstream>
+#include <sstream>
+
+#define kGameSessionHeader "MemoryGameSession 1"
+
+static const char* GetEventTypeName(GameSessionEventType inType)
+{
+	switch (inType)
+	{
+		case kGameSessionEvent_Deal:
+			return "deal";
+		case kGameSessionEvent_Reset:
+			return "reset";
+		case kGameSessionEvent_Press:
+			return "press";
+	}
+	return "";
+}
+
+void GameSession::Clear()
+{
+	mEvents.clear();
+	mDroppedEventCount = 0;
+}
+
+void GameSession::AddEvent(GameSessionEventType inType, uint32_t inTimeMs, uint64_t inValue)
+{
+	if (mEvents.size() >= kMaxEventCount)
+	{
+		// Keep the current game, it can still be replayed from its deal
+		size_t lastDeal = mEvents.size();
+		while (lastDeal > 0 && mEvents[lastDeal - 1].mType == kGameSessionEvent_Press)
+			lastDeal--;
+		if (lastDeal <= 1)
+		{
+			mDroppedEventCount++;
+			return;
+		}
+		mEvents.erase(mEvents.begin(), mEvents.begin() + (lastDeal - 1));
+	}
+
+	GameSessionEvent event;
+	event.mValue = inValue;
+	event.mTimeMs = inTimeMs;
+	event.mType = inType;
+	mEvents.push_back(event);
+}
+
+bool GameSession::WriteToFile(const std::string& inPath) const
+{
+	std::ofstream file(inPath, std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file << kGameSessionHeader << "\n";
+	for (const GameSessionEvent& event : mEvents)
+		file << event.mTimeMs << " " << GetEventTypeName(event.mType) << " " << event.mValue << "\n";
+	return file.good();
+}
+
+bool GameSession::ReadFromFile(const std::string& inPath)
+{
+	std::ifstream file(inPath);
+	if (!file.is_open())
+		return false;
+
+	std::string line;
+	if (!std::getline(file, line) || line != kGameSessionHeader)
+		return false;
+
+	std::vector<GameSessionEvent> events;
+	while (std::getline(file, line))
+	{
+		if (line.empty())
+			continue;
+
+		std::istringstream stream(line);
+		GameSessionEvent event;
+		std::string typeName;
+		if (!(stream >> event.mTimeMs >> typeName >> event.mValue))
+			return false;
+
+		if (typeName == GetEventTypeName(kGameSessionEvent_Deal))
+			event.mType = kGameSessionEvent_Deal;
+		else if (typeName == GetEventTypeName(kGameSessionEvent_Reset))
+			event.mType = kGameSessionEvent_Reset;
+		else if (typeName == GetEventTypeName(kGameSessionEvent_Press))
+			event.mType = kGameSessionEvent_Press;
+		else
+			return false;
+		events.push_back(event);
+	}
+
+	mEvents.swap(events);
+	mDroppedEventCount = 0;
+	return true;
+}
@@ -0,0 +1,62 @@
+//==============================================================================
+/**
+@file       GameSession.h
+
+@brief      Record of the deals and key presses of a game, to replay it
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum GameSessionEventType : uint32_t
+{
+	// A new board was dealt, when the game started or after it was solved. The value is the seed of the deal.
+	kGameSessionEvent_Deal,
+	// The reset key was pressed, dealing a new board. The value is the seed of the deal.
+	kGameSessionEvent_Reset,
+	// A tile was pressed. The value is the slot of the tile on the board.
+	kGameSessionEvent_Press
+};
+
+struct GameSessionEvent
+{
+	uint64_t				mValue = 0;
+	// Time since the session started
+	uint32_t				mTimeMs = 0;
+	GameSessionEventType	mType = kGameSessionEvent_Deal;
+};
+
+// The events of a game in the order they were handled. Every deal carries its own seed, so the events
+// from any deal on are enough to play the game again with the same boards.
+class GameSession
+{
+public:
+
+	void Clear();
+
+	// When the session is full, the events before the last deal are dropped
+	void AddEvent(GameSessionEventType inType, uint32_t inTimeMs, uint64_t inValue);
+
+	const std::vector<GameSessionEvent>& GetEvents() const { return mEvents; }
+	// Events that could not be recorded because a single game filled the session
+	size_t GetDroppedEventCount() const { return mDroppedEventCount; }
+
+	// One event per line as "<time ms> deal|reset|press <value>", after a header line
+	bool WriteToFile(const std::string& inPath) const;
+	bool ReadFromFile(const std::string& inPath);
+
+private:
+
+	static const size_t kMaxEventCount = 64 * 1024;
+
+	std::vector<GameSessionEvent> mEvents;
+	size_t mDroppedEventCount = 0;
+};
@@ -0,0 +1,49 @@
+//==============================================================================
+/**
+@file       GameSink.h
+
+@brief      Interface between the game logic and the keys it is played on
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "../Common/ESDKeyRenderer.h"
+#include "IconStore.h"
+
+#include <string>
+#include <vector>
+
+// Everything a MemoryGame needs from outside: the keys of its device, displaying titles and images on
+// them, the timers and animations (ESDKeyRenderer), the icons, the localized titles and the sound.
+// MyStreamDeckPlugin implements it for the Stream Deck, HeadlessGameSink runs games without one.
+class GameSink : public ESDKeyRenderer
+{
+public:
+
+	// The keys of the device, the games are built when they all appeared. Never nullptr, the game keeps
+	// the lists instead of copying them.
+	virtual ESDStringIDListPtr GetAllGameActionsForDevice(ESDStringID inDeviceId) = 0;
+	virtual ESDStringIDListPtr GetAllResetTilesForDevice(ESDStringID inDeviceId) = 0;
+
+	virtual void SetTitle(const std::string& inTitle, ESDStringID inContext) = 0;
+	virtual void SetImage(const std::string& inImage, ESDStringID inContext) = 0;
+	// Pre-render the image of a key once and display it later. SetPreparedImage() returns false if the
+	// image was not prepared for the key.
+	virtual void PrepareImage(const std::string& inImageId, const char* inImage, size_t inImageSize, ESDStringID inContext) = 0;
+	virtual bool SetPreparedImage(const std::string& inImageId, ESDStringID inContext) = 0;
+	// Deletes the titles and images of the keys
+	virtual void ClearKeys(const std::vector<ESDStringID>& inContexts) = 0;
+
+	// The icons of the pairs, empty to show the pairs as numbers. They must outlive the games.
+	virtual const std::vector<GameIcon>& GetTileIcons() = 0;
+	// nullptr to show a title on the reset keys
+	virtual const GameIcon* GetResetIcon() = 0;
+
+	virtual std::string GetLocalizedString(const std::string& inDefaultString) = 0;
+	virtual void PlaySoundGameFinished() = 0;
+};
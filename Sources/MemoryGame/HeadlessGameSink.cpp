@@ -0,0 +1,177 @@
+//==============================================================================
+/**
+@file       HeadlessGameSink.cpp
+
+@brief      Game sink without a Stream Deck, to run games in tools and benchmarks
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "HeadlessGameSink.h"
+
+// About the size of the base64 encoded PNG of a tile icon
+#define kHeadlessIconSize 4096
+
+HeadlessGameSink::HeadlessGameSink(const std::string& inDeviceId, size_t inTileCount, size_t inIconCount)
+{
+	ESDStringInterner& interner = ESDStringInterner::Get();
+	mDeviceId = interner.Intern(inDeviceId);
+	std::shared_ptr<ESDStringIDList> tileContexts = std::make_shared<ESDStringIDList>();
+	for (size_t i = 0; i < inTileCount; i++)
+	{
+		tileContexts->push_back(interner.Intern(inDeviceId + "/tile" + std::to_string(i)));
+		mTileIndices[tileContexts->back()] = i;
+	}
+	mTileContexts = tileContexts;
+	mTileFaces.resize(inTileCount);
+	mResetContext = interner.Intern(inDeviceId + "/reset");
+	mResetContexts = std::make_shared<const ESDStringIDList>(1, mResetContext);
+	mNoContexts = std::make_shared<const ESDStringIDList>();
+
+	mIconImages.reserve(inIconCount);
+	for (size_t i = 0; i < inIconCount; i++)
+		mIconImages.push_back("data:image/png;base64," + std::string(kHeadlessIconSize, (char)('A' + i % 26)));
+
+	// The images do not move anymore
+	for (size_t i = 0; i < inIconCount; i++)
+	{
+		GameIcon icon;
+		icon.mId = "icon" + std::to_string(i) + ".png";
+		icon.mBase64Image = mIconImages[i].data();
+		icon.mBase64ImageSize = mIconImages[i].size();
+		mTileIcons.push_back(icon);
+	}
+}
+
+void HeadlessGameSink::AdvanceTime(int inDelayMs)
+{
+	const uint64_t endMs = mTimeMs + (uint64_t)std::max(inDelayMs, 0);
+	while (!mTimers.empty() && mTimers.begin()->first.first <= endMs)
+		RunNextTimer();
+	mTimeMs = endMs;
+}
+
+bool HeadlessGameSink::RunNextTimer()
+{
+	if (mTimers.empty())
+		return false;
+
+	// The handler may start or cancel timers
+	auto timer = mTimers.begin();
+	std::function<void()> handler = std::move(timer->second);
+	mTimeMs = std::max(mTimeMs, timer->first.first);
+	mTimers.erase(timer);
+	handler();
+	return true;
+}
+
+void HeadlessGameSink::ResetCounters()
+{
+	mSendCount = 0;
+	mSendBytes = 0;
+}
+
+ESDStringIDListPtr HeadlessGameSink::GetAllGameActionsForDevice(ESDStringID inDeviceId)
+{
+	return inDeviceId == mDeviceId ? mTileContexts : mNoContexts;
+}
+
+ESDStringIDListPtr HeadlessGameSink::GetAllResetTilesForDevice(ESDStringID inDeviceId)
+{
+	return inDeviceId == mDeviceId ? mResetContexts : mNoContexts;
+}
+
+void HeadlessGameSink::SetTitle(const std::string& inTitle, ESDStringID inContext)
+{
+	CountSend(inTitle.size());
+	SetTileFace(inContext, inTitle);
+}
+
+void HeadlessGameSink::SetImage(const std::string& inImage, ESDStringID inContext)
+{
+	CountSend(inImage.size());
+	SetTileFace(inContext, inImage);
+}
+
+void HeadlessGameSink::PrepareImage(const std::string& inImageId, const char* /*inImage*/, size_t inImageSize, ESDStringID /*inContext*/)
+{
+	mPreparedImageSizes[inImageId] = inImageSize;
+}
+
+bool HeadlessGameSink::SetPreparedImage(const std::string& inImageId, ESDStringID inContext)
+{
+	auto image = mPreparedImageSizes.find(inImageId);
+	if (image == mPreparedImageSizes.end())
+		return false;
+
+	CountSend(image->second);
+	SetTileFace(inContext, inImageId);
+	return true;
+}
+
+void HeadlessGameSink::ClearKeys(const std::vector<ESDStringID>& inContexts)
+{
+	// An empty title and an empty image per key
+	for (ESDStringID context : inContexts)
+	{
+		CountSend(0);
+		CountSend(0);
+		SetTileFace(context, std::string());
+	}
+}
+
+ESDTimerID HeadlessGameSink::StartTimer(ESDStringID /*inDeviceID*/, int inDelayMs, const std::function<void()>& inHandler)
+{
+	ESDTimerID timerID = ++mLastTimerID;
+	mTimers[std::make_pair(mTimeMs + (uint64_t)std::max(inDelayMs, 0), timerID)] = inHandler;
+	return timerID;
+}
+
+void HeadlessGameSink::CancelTimer(ESDTimerID inTimerID)
+{
+	// Only a few timers run at once
+	for (auto timer = mTimers.begin(); timer != mTimers.end(); ++timer)
+	{
+		if (timer->first.second == inTimerID)
+		{
+			mTimers.erase(timer);
+			return;
+		}
+	}
+}
+
+void HeadlessGameSink::SetKeys(const std::vector<ESDKeyChange>& inChanges)
+{
+	for (const ESDKeyChange& change : inChanges)
+	{
+		if (!change.mPreparedImageId.empty())
+		{
+			SetPreparedImage(change.mPreparedImageId, change.mContext);
+			continue;
+		}
+		CountSend(change.mValue.size());
+		SetTileFace(change.mContext, change.mValue);
+	}
+}
+
+std::chrono::steady_clock::time_point HeadlessGameSink::GetTime() const
+{
+	return std::chrono::steady_clock::time_point(std::chrono::milliseconds(mTimeMs));
+}
+
+void HeadlessGameSink::CountSend(size_t inBytes)
+{
+	mSendCount++;
+	mSendBytes += inBytes;
+}
+
+void HeadlessGameSink::SetTileFace(ESDStringID inContext, const std::string& inFace)
+{
+	// The last change wins, whether it is a title or an image
+	auto tile = mTileIndices.find(inContext);
+	if (tile != mTileIndices.end())
+		mTileFaces[tile->second] = inFace;
+}
@@ -0,0 +1,95 @@
+//==============================================================================
+/**
+@file       HeadlessGameSink.h
+
+@brief      Game sink without a Stream Deck, to run games in tools and benchmarks
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "GameSink.h"
+
+#include <map>
+#include <unordered_map>
+
+// Plays games on a virtual device: the tile keys and one reset key are interned contexts, the key changes
+// are only counted and the timers run on a virtual clock advanced by the caller. Not thread-safe, the
+// games and the clock must be driven from one thread.
+class HeadlessGameSink : public GameSink
+{
+public:
+
+	// A device with inTileCount tile keys and inIconCount synthetic icons, 0 to show the pairs as numbers
+	HeadlessGameSink(const std::string& inDeviceId, size_t inTileCount, size_t inIconCount);
+
+	ESDStringID GetDeviceId() const { return mDeviceId; }
+	const ESDStringIDList& GetTileContexts() const { return *mTileContexts; }
+	ESDStringID GetResetContext() const { return mResetContext; }
+	// What the tile key shows, the id of its prepared image, its image or its title. Empty if nothing.
+	const std::string& GetTileFace(size_t inTile) const { return mTileFaces[inTile]; }
+
+	// Runs the timers that are due within the next inDelayMs of virtual time, in order
+	void AdvanceTime(int inDelayMs);
+	// Jumps to the next timer and runs it, returns false if no timer is running
+	bool RunNextTimer();
+	bool HasTimers() const { return !mTimers.empty(); }
+
+	// Key changes (titles and images) and the bytes of their values since the last ResetCounters()
+	uint64_t GetSendCount() const { return mSendCount; }
+	uint64_t GetSendBytes() const { return mSendBytes; }
+	void ResetCounters();
+	// Games solved since the sink was created
+	uint64_t GetFinishedGameCount() const { return mFinishedGameCount; }
+
+	// GameSink
+	ESDStringIDListPtr GetAllGameActionsForDevice(ESDStringID inDeviceId) override;
+	ESDStringIDListPtr GetAllResetTilesForDevice(ESDStringID inDeviceId) override;
+	void SetTitle(const std::string& inTitle, ESDStringID inContext) override;
+	void SetImage(const std::string& inImage, ESDStringID inContext) override;
+	void PrepareImage(const std::string& inImageId, const char* inImage, size_t inImageSize, ESDStringID inContext) override;
+	bool SetPreparedImage(const std::string& inImageId, ESDStringID inContext) override;
+	void ClearKeys(const std::vector<ESDStringID>& inContexts) override;
+	const std::vector<GameIcon>& GetTileIcons() override { return mTileIcons; }
+	const GameIcon* GetResetIcon() override { return nullptr; }
+	std::string GetLocalizedString(const std::string& inDefaultString) override { return inDefaultString; }
+	void PlaySoundGameFinished() override { mFinishedGameCount++; }
+
+	// ESDKeyRenderer
+	ESDTimerID StartTimer(ESDStringID inDeviceID, int inDelayMs, const std::function<void()>& inHandler) override;
+	void CancelTimer(ESDTimerID inTimerID) override;
+	void SetKeys(const std::vector<ESDKeyChange>& inChanges) override;
+	std::chrono::steady_clock::time_point GetTime() const override;
+
+private:
+
+	void CountSend(size_t inBytes);
+	void SetTileFace(ESDStringID inContext, const std::string& inFace);
+
+	ESDStringID mDeviceId = kESDNoStringID;
+	ESDStringIDListPtr mTileContexts;
+	ESDStringID mResetContext = kESDNoStringID;
+	ESDStringIDListPtr mResetContexts;
+	ESDStringIDListPtr mNoContexts;
+	std::unordered_map<ESDStringID, size_t> mTileIndices;
+	std::vector<std::string> mTileFaces;
+
+	// The base64 images of the synthetic icons, mTileIcons point into them
+	std::vector<std::string> mIconImages;
+	std::vector<GameIcon> mTileIcons;
+	// Size of each prepared image, the images are the same for all keys
+	std::unordered_map<std::string, size_t> mPreparedImageSizes;
+
+	// Running timers ordered by due time, then by start order
+	std::map<std::pair<uint64_t, ESDTimerID>, std::function<void()>> mTimers;
+	ESDTimerID mLastTimerID = 0;
+	uint64_t mTimeMs = 0;
+
+	uint64_t mSendCount = 0;
+	uint64_t mSendBytes = 0;
+	uint64_t mFinishedGameCount = 0;
+};
@@ -0,0 +1,103 @@
+//==============================================================================
+/**
+@file       IconStore.cpp
+
+@brief      Game icons shared by all games of the process
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "IconStore.h"
+#include "../Vendor/cppcodec/cppcodec/base64_rfc4648.hpp"
+#include "../Common/ESDUtilities.h"
+#include "../Common/ESDResourcePack.h"
+
+#include <fstream>
+
+
+const IconStore& IconStore::Get()
+{
+	// Initialized by the first caller, the other threads wait until it is loaded
+	static const IconStore sIconStore;
+	return sIconStore;
+}
+
+// find the images for game tiles and reset icon as base 64 encoded strings
+IconStore::IconStore()
+{
+	mIsComplete = true;
+	
+	std::string pluginPath = ESDUtilities::GetPluginPath();
+	if (pluginPath.empty())
+	{
+		mIsComplete = false;
+		return;
+	}
+	
+	// tile icons
+	for (int i = 1; i < 16; i++)
+	{
+		GameIcon icon;
+		icon.mId = std::to_string(i) + ".png";
+		if (LoadIcon(pluginPath, icon))
+		{
+			mTileIcons.push_back(icon);
+		}
+		else
+		{
+			mIsComplete = false;
+			DebugPrint("Could not load icon: %d.png\n", i);
+		}
+	}
+	
+	// reset icon
+	mResetIcon.mId = "startover.png";
+	if (!LoadIcon(pluginPath, mResetIcon))
+	{
+		mIsComplete = false;
+		DebugPrint("Could not load icon: startover.png\n");
+	}
+}
+
+bool IconStore::LoadIcon(const std::string& inPluginPath, GameIcon& ioIcon)
+{
+	// The pack holds the icons already encoded
+	if (ESDResourcePack::Get().GetResource(ioIcon.mId, ioIcon.mBase64Image, ioIcon.mBase64ImageSize))
+		return true;
+	
+	std::string encodedFile;
+	if (!GetEncodedIconStringFromFile(ESDUtilities::AddPathComponent(inPluginPath, ioIcon.mId), encodedFile))
+		return false;
+	
+	mLoadedImages.push_back(std::move(encodedFile));
+	ioIcon.mBase64Image = mLoadedImages.back().data();
+	ioIcon.mBase64ImageSize = mLoadedImages.back().size();
+	return true;
+}
+
+bool IconStore::GetEncodedIconStringFromFile(const std::string& inName, std::string& outFileString)
+{
+	bool success = false;
+	std::ifstream pngFile(inName, std::ios::binary | std::ios::ate);
+	if (pngFile.is_open())
+	{
+		std::ifstream::pos_type pos = pngFile.tellg();
+
+		std::vector<char> result(pos);
+
+		pngFile.seekg(0, std::ios::beg);
+		pngFile.read(&result[0], pos);
+
+		outFileString = cppcodec::base64_rfc4648::encode(&result[0], result.size());
+		success = true;
+	}
+	else
+	{
+		success = false;
+		DebugPrint("Could not load icon: %s", inName.c_str());
+	}
+	return success;
+}
@@ -0,0 +1,62 @@
+//==============================================================================
+/**
+@file       IconStore.h
+
+@brief      Game icons shared by all games of the process
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// A game icon, encoded for the setImage message
+struct GameIcon
+{
+	// File name of the icon, also used as the id of its prepared setImage message
+	std::string mId;
+	// Points into the resource pack, or into the icon store if the icon was loaded from its file
+	const char* mBase64Image = nullptr;
+	size_t mBase64ImageSize = 0;
+};
+
+// Read-only store of the game icons, set up once on the first call of Get(). The icons are read in place
+// from the resource pack, or loaded from their files and encoded if the plugin has no pack.
+// The store is never modified afterwards, so the games can keep pointers to its icons and use them
+// from any thread without locking.
+class IconStore
+{
+public:
+
+	static const IconStore& Get();
+
+	// The tile icons that could be loaded, in the order of their file names
+	const std::vector<GameIcon>& GetTileIcons() const { return mTileIcons; }
+	// nullptr if the reset icon could not be loaded
+	const GameIcon* GetResetIcon() const { return mResetIcon.mBase64ImageSize == 0 ? nullptr : &mResetIcon; }
+	// False if any of the icons could not be loaded
+	bool IsComplete() const { return mIsComplete; }
+
+private:
+
+	IconStore();
+
+	// Finds the icon in the resource pack, or loads it from its file. Returns false if neither worked.
+	bool LoadIcon(const std::string& inPluginPath, GameIcon& ioIcon);
+
+	// Reads a file into a base64 encoded string
+	static bool GetEncodedIconStringFromFile(const std::string& inName, std::string& outFileString);
+
+	// Encoded icons loaded from their files, a deque does not move them when it grows
+	std::deque<std::string> mLoadedImages;
+
+	std::vector<GameIcon> mTileIcons;
+	GameIcon mResetIcon;
+	bool mIsComplete = false;
+};
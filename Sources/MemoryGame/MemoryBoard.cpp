@@ -0,0 +1,79 @@
+//==============================================================================
+/**
+@file       MemoryBoard.cpp
+
+@brief      Tiles of a game, their pairs and their state
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "MemoryBoard.h"
+
+#include <utility>
+
+
+void MemoryBoard::Reset(const std::vector<ESDStringID>& inContexts)
+{
+	mContexts = inContexts;
+	mPartners.assign(mContexts.size(), kNoSlot);
+	mFaces.assign(mContexts.size(), -1);
+	mStates.assign(mContexts.size(), 0);
+	mUnfinishedPairCount = 0;
+	
+	mSlotsForContexts.clear();
+	mSlotsForContexts.reserve(mContexts.size());
+	for (size_t slot = 0; slot < mContexts.size(); slot++)
+	{
+		mSlotsForContexts.emplace(mContexts[slot], (BoardSlot)slot);
+	}
+}
+
+void MemoryBoard::SetPair(BoardSlot inSlot1, BoardSlot inSlot2, int inFace)
+{
+	mPartners[inSlot1] = inSlot2;
+	mPartners[inSlot2] = inSlot1;
+	mFaces[inSlot1] = inFace;
+	mFaces[inSlot2] = inFace;
+	mStates[inSlot1] = kSlotPaired;
+	mStates[inSlot2] = kSlotPaired;
+	mUnfinishedPairCount++;
+}
+
+void MemoryBoard::FinishPair(BoardSlot inSlot)
+{
+	BoardSlot partner = mPartners[inSlot];
+	if (partner == kNoSlot || IsFinished(inSlot))
+		return;
+	
+	mStates[inSlot] |= kSlotFinished;
+	mStates[partner] |= kSlotFinished;
+	mUnfinishedPairCount--;
+}
+
+size_t MemoryBoard::DealPairs(GameRandom& ioRandom)
+{
+	size_t pairedSlotCount = mContexts.size() & ~(size_t)1;
+	
+	mDealOrder.resize(pairedSlotCount);
+	for (size_t i = 0; i < pairedSlotCount; i++)
+		mDealOrder[i] = (BoardSlot)i;
+	
+	for (size_t i = pairedSlotCount; i > 1; i--)
+		std::swap(mDealOrder[i - 1], mDealOrder[ioRandom.NextBelow((uint32_t)i)]);
+	
+	for (size_t i = 0; i < pairedSlotCount; i += 2)
+		SetPair(mDealOrder[i], mDealOrder[i + 1], (int)(i / 2));
+	
+	return pairedSlotCount / 2;
+}
+
+BoardSlot MemoryBoard::GetSlot(ESDStringID inContext) const
+{
+	auto it = mSlotsForContexts.find(inContext);
+	if (it != mSlotsForContexts.end())
+		return it->second;
+	return kNoSlot;
+}
@@ -0,0 +1,77 @@
+//==============================================================================
+/**
+@file       MemoryBoard.h
+
+@brief      Tiles of a game, their pairs and their state
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "../Common/ESDStringInterner.h"
+#include "GameRandom.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Index of a tile on the board
+typedef int BoardSlot;
+static const BoardSlot kNoSlot = -1;
+
+// The contexts of the tiles are mapped to slots once when the board is set up. The pairs, faces and
+// states are kept in flat arrays indexed by slot, so handling a key press only reads a few array entries.
+class MemoryBoard
+{
+public:
+
+	// Assigns a slot to each context in order. No slot is paired yet.
+	void Reset(const std::vector<ESDStringID>& inContexts);
+	// Pairs two slots showing the same face
+	void SetPair(BoardSlot inSlot1, BoardSlot inSlot2, int inFace);
+	// Marks the slot and its partner as finished
+	void FinishPair(BoardSlot inSlot);
+	// Pairs all slots at random with a Fisher-Yates shuffle, the pairs get the faces 0, 1, 2, ...
+	// With an odd number of slots the last slot stays unpaired. Returns the number of pairs.
+	size_t DealPairs(GameRandom& ioRandom);
+
+	// Returns kNoSlot if the context is not a tile of the board
+	BoardSlot GetSlot(ESDStringID inContext) const;
+
+	size_t GetSlotCount() const { return mContexts.size(); }
+	const std::vector<ESDStringID>& GetContexts() const { return mContexts; }
+	ESDStringID GetContext(BoardSlot inSlot) const { return mContexts[inSlot]; }
+
+	// kNoSlot if the slot is not paired
+	BoardSlot GetPartner(BoardSlot inSlot) const { return mPartners[inSlot]; }
+	// -1 if the slot is not paired
+	int GetFace(BoardSlot inSlot) const { return mFaces[inSlot]; }
+	bool IsFinished(BoardSlot inSlot) const { return (mStates[inSlot] & kSlotFinished) != 0; }
+
+	size_t GetUnfinishedPairCount() const { return mUnfinishedPairCount; }
+
+private:
+
+	enum : uint8_t
+	{
+		kSlotPaired = 1 << 0,
+		kSlotFinished = 1 << 1
+	};
+
+	std::unordered_map<ESDStringID, BoardSlot> mSlotsForContexts;
+
+	// Indexed by slot
+	std::vector<ESDStringID> mContexts;
+	std::vector<BoardSlot> mPartners;
+	std::vector<int> mFaces;
+	std::vector<uint8_t> mStates;
+
+	// Reused by DealPairs()
+	std::vector<BoardSlot> mDealOrder;
+
+	size_t mUnfinishedPairCount = 0;
+};
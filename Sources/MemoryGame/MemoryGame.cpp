@@ -11,54 +11,78 @@
 //==============================================================================
 
 #include "MemoryGame.h"
-#include "../MyStreamDeckPlugin.h"
-#include "../Vendor/cppcodec/cppcodec/base64_rfc4648.hpp"
-#include "../Common/ESDLocalizer.h"
-#include "../Common/ESDUtilities.h"
+#include "../Common/ESDAnimation.h"
 
-#ifdef __APPLE__
-	#include "../macOS/PlatformSpecific.h"
-#else
-	#include "../Windows/PlatformSpecific.h"
-#endif
-std::default_random_engine MemoryGame::sRandomNumberGenerator(std::random_device{}());
+#include <algorithm>
+#include <random>
 
-MemoryGame::MemoryGame(MyStreamDeckPlugin* inPlugin, const std::string& inDeviceId)
+static const ESDStringIDListPtr& GetNoContexts()
 {
-	mMemoryGamePlugin = inPlugin;
+	static const ESDStringIDListPtr sNoContexts = std::make_shared<const ESDStringIDList>();
+	return sNoContexts;
+}
+
+// Appends the changes deleting the titles and images of the keys
+static void AddClearKeyChanges(const std::vector<ESDStringID>& inContexts, std::vector<ESDKeyChange>& ioChanges)
+{
+	for (const auto& context : inContexts)
+	{
+		ESDKeyChange change;
+		change.mContext = context;
+		change.mIsImage = false;
+		ioChanges.push_back(change);
+		change.mIsImage = true;
+		ioChanges.push_back(change);
+	}
+}
+
+MemoryGame::MemoryGame(GameSink* inSink, ESDStringID inDeviceId)
+{
+	mSink = inSink;
 	mDeviceId = inDeviceId;
-	if (inPlugin != nullptr && !inDeviceId.empty())
+	mResetTileContexts = GetNoContexts();
+	
+	std::random_device randomDevice;
+	mSeedRandom.Seed(((uint64_t)randomDevice() << 32) | randomDevice());
+	mSessionStart = GetTime();
+	
+	if (inSink != nullptr && inDeviceId != kESDNoStringID)
+	{
+		mSuccessAnimation.reset(new ESDAnimationPlayer(inSink, inDeviceId));
 		InitGame();
+	}
 }
 
 MemoryGame::~MemoryGame()
 {
-	ClearKeys(mAllGameTileContexts);
-	ClearKeys(mResetTileContexts);
-	JoinAllAnimationTimers();
+	ClearKeys(mBoard.GetContexts());
+	ClearKeys(*mResetTileContexts);
+	StopReplay();
+	CancelAllAnimationTimers();
 }
 
-bool MemoryGame::ContextHasIcon(const std::string& inContext) const
+bool MemoryGame::SlotHasIcon(BoardSlot inSlot) const
 {
-	return mIconsForContexts.find(inContext) != mIconsForContexts.end();
+	return GetIconForSlot(inSlot) != nullptr;
 }
 
-bool MemoryGame::ContextHasTitle(const std::string& inContext) const
+bool MemoryGame::SlotHasTitle(BoardSlot inSlot) const
 {
-	return mTitlesForContexts.find(inContext) != mTitlesForContexts.end();
+	return mBoard.GetFace(inSlot) >= (int)mFaceIcons.size();
 }
 
-std::string MemoryGame::GetEncodedIconForContext(const std::string& inContext)
+const GameIcon* MemoryGame::GetIconForSlot(BoardSlot inSlot) const
 {
-	if (ContextHasIcon(inContext))
-		return mIconsForContexts[inContext];
-	return "";
+	int face = mBoard.GetFace(inSlot);
+	if (face >= 0 && face < (int)mFaceIcons.size())
+		return mFaceIcons[face];
+	return nullptr;
 }
 
-std::string MemoryGame::GetHelperTitleForContext(const std::string& inContext)
+std::string MemoryGame::GetHelperTitleForSlot(BoardSlot inSlot) const
 {
-	if (ContextHasTitle(inContext))
-		return mTitlesForContexts[inContext];
+	if (SlotHasTitle(inSlot))
+		return std::to_string(mBoard.GetFace(inSlot));
 	
 	return "";
 }
@@ -66,146 +90,276 @@ std::string MemoryGame::GetHelperTitleForContext(const std::string& inContext)
 // Initializes the game, resets all lists etc
 void MemoryGame::InitGame()
 {
+	DealGame(kGameSessionEvent_Deal, mSeedRandom.Next());
+}
+
+void MemoryGame::HandleResetPressed()
+{
+	StopReplay();
+	DealGame(kGameSessionEvent_Reset, mSeedRandom.Next());
+}
+
+void MemoryGame::DealGame(GameSessionEventType inType, uint64_t inSeed)
+{
+	RecordEvent(inType, inSeed);
+	mRandom.Seed(inSeed);
+	
 	// make sure no animation is playing anymore
-	JoinAllAnimationTimers();
+	CancelAllAnimationTimers();
 
-	// Clear all keys
-	ClearKeys(mAllGameTileContexts);
-	ClearKeys(mResetTileContexts);
+	// Clear all keys, together with the reset keys of the new board this is the first frame of the game
+	std::vector<ESDKeyChange> changes;
+	changes.reserve(2 * (mBoard.GetContexts().size() + mResetTileContexts->size()));
+	AddClearKeyChanges(mBoard.GetContexts(), changes);
+	AddClearKeyChanges(*mResetTileContexts, changes);
 
-	// load icons
-	bool success = LoadIcons();
-	if (!success)
-	{
-		DebugPrint("Something went wrong when loading icons, use titles instead.\n");
-		mIcons.clear();
-	}
+	// the icons are loaded once for all games
+	mIcons.clear();
+	for (const GameIcon& icon : mSink->GetTileIcons())
+		mIcons.push_back(&icon);
+	mResetIcon = mSink->GetResetIcon();
 
 	// clear all lists etc
-	mResetTileContexts.clear();
-	mUnfinishedPairs.clear();
-	mFinishedContexts.clear();
-	mCurrentRevealedContext.clear();
-	mIconsForContexts.clear();
+	mResetTileContexts = GetNoContexts();
+	mFaceIcons.clear();
+	mRevealedSlot = kNoSlot;
 
 	// rebuild the pairs
 	BuildActionPairs();
 
 	// display the reset image or title on the reset keys
 	mResetTileContexts = GetAllResetTilesForDevice();
-	for (const auto& context : mResetTileContexts)
+	for (const auto& context : *mResetTileContexts)
 	{
-		if (!mResetIcon.empty())
+		ESDKeyChange change;
+		change.mContext = context;
+		if (mResetIcon != nullptr)
 		{
-			mMemoryGamePlugin->SetImage(mResetIcon, context);
+			mSink->PrepareImage(mResetIcon->mId, mResetIcon->mBase64Image, mResetIcon->mBase64ImageSize, context);
+			change.mIsImage = true;
+			change.mPreparedImageId = mResetIcon->mId;
 		}
 		else
 		{
-			mMemoryGamePlugin->SetTitle(ESDLocalizer::GetLocalizedString("Reset"), context);
+			change.mValue = mSink->GetLocalizedString("Reset");
 		}
+		changes.push_back(change);
 	}
+	
+	// the board is playable once this batch was displayed
+	mSink->SetKeys(changes);
+}
+
+void MemoryGame::SetRandomSeed(uint64_t inSeed)
+{
+	mSeedRandom.Seed(inSeed);
 }
 
 // Handling key presses for game tiles.
 // when no tile is revealed, reveal tile
 // when there is a already tile revealed and new tile does not match, reveal both for a short time, then hide both
 // when there is a already tile revealed and new tile matches, mark pair as resolved etc
-void MemoryGame::HandleMemoryTilePressed(const std::string& inContext)
+void MemoryGame::HandleMemoryTilePressed(ESDStringID inContext)
+{
+	StopReplay();
+	PressSlot(mBoard.GetSlot(inContext));
+}
+
+void MemoryGame::PressSlot(BoardSlot inSlot)
 {
-	if (mFinishedContexts.find(inContext) != mFinishedContexts.end() || inContext == mCurrentRevealedContext)
+	if (inSlot < 0 || (size_t)inSlot >= mBoard.GetSlotCount())
+		return;
+	
+	RecordEvent(kGameSessionEvent_Press, (uint64_t)inSlot);
+	
+	if (mBoard.IsFinished(inSlot) || inSlot == mRevealedSlot)
 		return;
-	else if (mCurrentRevealedContext.empty())
+	else if (mRevealedSlot == kNoSlot)
 	{
-		// reveal image of key
-		mStopDisplayingMismatch = true;
-		mCurrentRevealedContext = inContext;
-		SendRevealContext(inContext);
+		// hide the last mismatch right away and reveal image of key
+		HideMismatch();
+		mRevealedSlot = inSlot;
+		SendRevealSlot(inSlot);
 	}
-	else if (mCurrentRevealedContext != inContext && mUnfinishedPairs[inContext] != mCurrentRevealedContext)
+	else if (mBoard.GetPartner(inSlot) != mRevealedSlot)
 	{
-		// not a match, reveal both for a second and hide both
-		SendRevealContext(inContext);
-		mStopDisplayingMismatch = false;
-		std::string context2 = mCurrentRevealedContext;
-		// thread will wait a second or until a new key is pressed and hide both keys
-		std::thread* displayHelperTimer = new std::thread([inContext, context2, this]()
-		{
-			for (int i = 0; i < 10; i++)
+		// not a match, reveal both for a second or until a new key is pressed and hide both
+		SendRevealSlot(inSlot);
+		mMismatchSlots[0] = inSlot;
+		mMismatchSlots[1] = mRevealedSlot;
+		if (mSink != nullptr)
+			mMismatchTimer = mSink->StartTimer(mDeviceId, 1000, [this]()
 			{
-				if (mStopDisplayingMismatch) // new key was pressed
-					break;
-				ESDUtilities::DoSleep(100);
-			}
-
-			SendHideContext(inContext);
-			SendHideContext(context2);
-			mStopDisplayingMismatch = false;
-		});
-		mDisplayHelperTimers.push_back(displayHelperTimer);
-		mCurrentRevealedContext = "";
+				mMismatchTimer = 0;
+				HideMismatch();
+			});
+		mRevealedSlot = kNoSlot;
 	}
-	else if (mCurrentRevealedContext != inContext && mUnfinishedPairs[inContext] == mCurrentRevealedContext)
+	else
 	{
 		// pair matches, show both keys as solved and check if game is finished
-		SendSolvedContext(inContext);
-		SendSolvedContext(mCurrentRevealedContext);
+		SendSolvedSlot(inSlot);
+		SendSolvedSlot(mRevealedSlot);
 
-		mFinishedContexts.insert(inContext);
-		mFinishedContexts.insert(mCurrentRevealedContext);
-		mUnfinishedPairs.erase(inContext);
-		mUnfinishedPairs.erase(mCurrentRevealedContext);
-		mCurrentRevealedContext = "";
+		mBoard.FinishPair(inSlot);
+		mRevealedSlot = kNoSlot;
 
-		if (mUnfinishedPairs.empty())
+		if (mBoard.GetUnfinishedPairCount() == 0)
 		{
 			// Game is finished, play sound and show animation
-			PlatformSpecific::PlaySoundGameFinished();
-			auto contextsForAnimation = mAllGameTileContexts;
-			ShowSuccessAnimationAndRestart(contextsForAnimation);
+			mSink->PlaySoundGameFinished();
+			ShowSuccessAnimationAndRestart(mBoard.GetContexts());
 		}
 	}
 }
 
-void MemoryGame::ShowSuccessAnimationAndRestart(const std::vector<std::string>& inContexts)
+void MemoryGame::ShowSuccessAnimationAndRestart(const std::vector<ESDStringID>& inContexts)
 {
-	if (mMemoryGamePlugin == nullptr)
+	if (mSink == nullptr)
 		return;
-	// show animation in thread by letting the title "Solved" flash on all keys and reinitialize the game
-	std::thread* ani = new std::thread([inContexts, this]
+	// show animation by letting the title "Solved" flash on all keys and reinitialize the game.
+	// Every 500 ms the titles of all keys are cleared or set to "Solved" together, 5 times.
+	ESDAnimationTimeline timeline;
+	std::string solved = mSink->GetLocalizedString("Solved");
+	for (int i = 0; i < 10; i++)
 	{
-		for (int i = 0; i < 5; i++)
+		for (const auto& context : inContexts)
 		{
-			ESDUtilities::DoSleep(500);
-			for (auto context : inContexts)
-			{
-				mMemoryGamePlugin->SetTitle("", context);
-			}
-			ESDUtilities::DoSleep(500);
-			for (auto context : inContexts)
-			{
-				mMemoryGamePlugin->SetTitle(ESDLocalizer::GetLocalizedString("Solved"), context);
-			}
+			timeline.SetTitle(500 * (i + 1), context, i % 2 == 0 ? "" : solved);
 		}
-		InitGame();
+	}
+	
+	mSuccessAnimation->Play(timeline, [this]()
+	{
+		// While replaying, the recorded deal follows
+		if (!mReplaying)
+			InitGame();
+	});
+}
+
+std::chrono::steady_clock::time_point MemoryGame::GetTime() const
+{
+	return mSink != nullptr ? mSink->GetTime() : std::chrono::steady_clock::now();
+}
+
+uint32_t MemoryGame::GetSessionTimeMs() const
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(GetTime() - mSessionStart).count();
+}
+
+void MemoryGame::RecordEvent(GameSessionEventType inType, uint64_t inValue)
+{
+	uint32_t timeMs = mReplaying ? mReplayEvents[mNextReplayEvent].mTimeMs : GetSessionTimeMs();
+	mSession.AddEvent(inType, timeMs, inValue);
+}
+
+void MemoryGame::Replay(const GameSession& inSession, bool inAsFastAsPossible)
+{
+	StopReplay();
+	
+	mSession.Clear();
+	mSessionStart = GetTime();
+	mReplayEvents = inSession.GetEvents();
+	mNextReplayEvent = 0;
+	mReplayStartTimeMs = mReplayEvents.empty() ? 0 : mReplayEvents.front().mTimeMs;
+	mReplaying = true;
+	
+	if (inAsFastAsPossible)
+	{
+		for (; mNextReplayEvent < mReplayEvents.size(); mNextReplayEvent++)
+			HandleReplayEvent(mReplayEvents[mNextReplayEvent]);
+		StopReplay();
+	}
+	else
+	{
+		ContinueReplay();
+	}
+}
+
+void MemoryGame::StopReplay()
+{
+	if (mSink != nullptr)
+		mSink->CancelTimer(mReplayTimer);
+	mReplayTimer = 0;
+	mReplaying = false;
+	mReplayEvents.clear();
+	mNextReplayEvent = 0;
+}
 
+void MemoryGame::ContinueReplay()
+{
+	// The session may start late if its beginning was dropped, so the times are relative to the first event
+	uint32_t elapsedMs = GetSessionTimeMs();
+	while (mNextReplayEvent < mReplayEvents.size() && mReplayEvents[mNextReplayEvent].mTimeMs - mReplayStartTimeMs <= elapsedMs)
+	{
+		HandleReplayEvent(mReplayEvents[mNextReplayEvent]);
+		mNextReplayEvent++;
+	}
+	
+	if (mNextReplayEvent == mReplayEvents.size() || mSink == nullptr)
+	{
+		StopReplay();
+		return;
+	}
+	
+	int delayMs = (int)(mReplayEvents[mNextReplayEvent].mTimeMs - mReplayStartTimeMs - elapsedMs);
+	mReplayTimer = mSink->StartTimer(mDeviceId, delayMs, [this]()
+	{
+		mReplayTimer = 0;
+		ContinueReplay();
 	});
-	ani->detach();
-	mDisplayHelperTimers.push_back(ani);
 }
 
+void MemoryGame::HandleReplayEvent(const GameSessionEvent& inEvent)
+{
+	switch (inEvent.mType)
+	{
+		case kGameSessionEvent_Deal:
+		case kGameSessionEvent_Reset:
+			DealGame(inEvent.mType, inEvent.mValue);
+			break;
+		case kGameSessionEvent_Press:
+			if (inEvent.mValue < mBoard.GetSlotCount())
+				PressSlot((BoardSlot)inEvent.mValue);
+			break;
+	}
+}
+
+void MemoryGame::HideMismatch()
+{
+	if (mSink != nullptr)
+		mSink->CancelTimer(mMismatchTimer);
+	mMismatchTimer = 0;
+	
+	for (BoardSlot& slot : mMismatchSlots)
+	{
+		if (slot != kNoSlot)
+			SendHideSlot(slot);
+		slot = kNoSlot;
+	}
+}
+
+// Display the icon of the key, using the message prepared when the pairs were built if possible
+void MemoryGame::SendIconForSlot(BoardSlot inSlot)
+{
+	const GameIcon* icon = GetIconForSlot(inSlot);
+	ESDStringID context = mBoard.GetContext(inSlot);
+	if (icon != nullptr && !mSink->SetPreparedImage(icon->mId, context))
+		mSink->SetImage(std::string(icon->mBase64Image, icon->mBase64ImageSize), context);
+}
 
 // Reveal the Image / Caption of the key when guessing
-void MemoryGame::SendRevealContext(const std::string& inContext)
+void MemoryGame::SendRevealSlot(BoardSlot inSlot)
 {
-	if (mMemoryGamePlugin != nullptr)
+	if (mSink != nullptr)
 	{
-		if (ContextHasIcon(inContext))
+		if (SlotHasIcon(inSlot))
 		{
-			mMemoryGamePlugin->SetImage(GetEncodedIconForContext(inContext), inContext);
+			SendIconForSlot(inSlot);
 		}
-		else if (ContextHasTitle(inContext))
+		else if (SlotHasTitle(inSlot))
 		{
-			mMemoryGamePlugin->SetTitle(GetHelperTitleForContext(inContext), inContext);
+			mSink->SetTitle(GetHelperTitleForSlot(inSlot), mBoard.GetContext(inSlot));
 		}
 		else
 		{
@@ -215,17 +369,17 @@ void MemoryGame::SendRevealContext(const std::string& inContext)
 }
 
 // Hide the Image / Caption of the key
-void MemoryGame::SendHideContext(const std::string& inContext)
+void MemoryGame::SendHideSlot(BoardSlot inSlot)
 {
-	if (mMemoryGamePlugin != nullptr)
+	if (mSink != nullptr)
 	{
-		if (ContextHasIcon(inContext))
+		if (SlotHasIcon(inSlot))
 		{
-			mMemoryGamePlugin->SetImage("", inContext);
+			mSink->SetImage("", mBoard.GetContext(inSlot));
 		}
-		else if (ContextHasTitle(inContext))
+		else if (SlotHasTitle(inSlot))
 		{
-			mMemoryGamePlugin->SetTitle("", inContext);
+			mSink->SetTitle("", mBoard.GetContext(inSlot));
 		}
 		else
 		{
@@ -235,17 +389,17 @@ void MemoryGame::SendHideContext(const std::string& inContext)
 }
 
 // Reveal the Image or display "Solved" when image pair was succesfully matched
-void MemoryGame::SendSolvedContext(const std::string& inContext)
+void MemoryGame::SendSolvedSlot(BoardSlot inSlot)
 {
-	if (mMemoryGamePlugin != nullptr)
+	if (mSink != nullptr)
 	{
-		if (ContextHasIcon(inContext))
+		if (SlotHasIcon(inSlot))
 		{
-			mMemoryGamePlugin->SetImage(GetEncodedIconForContext(inContext), inContext);
+			SendIconForSlot(inSlot);
 		}
-		else if (ContextHasTitle(inContext))
+		else if (SlotHasTitle(inSlot))
 		{
-			mMemoryGamePlugin->SetTitle(ESDLocalizer::GetLocalizedString("Solved"), inContext);
+			mSink->SetTitle(mSink->GetLocalizedString("Solved"), mBoard.GetContext(inSlot));
 		}
 		else
 		{
@@ -255,152 +409,78 @@ void MemoryGame::SendSolvedContext(const std::string& inContext)
 }
 
 
-// Make sure, all animation threads are done
-void MemoryGame::JoinAllAnimationTimers()
-{
-	while (!mDisplayHelperTimers.empty())
-	{
-		auto timerPtr = *mDisplayHelperTimers.begin();
-		if (timerPtr != nullptr && timerPtr->joinable())
-		{
-			timerPtr->join();
-			delete timerPtr;
-			timerPtr = nullptr;
-		}
-		mDisplayHelperTimers.pop_front();
-	}
-	mStopDisplayingMismatch = false;
-}
-
-// load images for game tiles and reset icon and stores them as base 64 encoded string
-bool MemoryGame::LoadIcons()
+// Stop all animations. They run on the strand of the device, so a cancelled handler cannot be running.
+void MemoryGame::CancelAllAnimationTimers()
 {
-	mIcons.clear();
-	mResetIcon.clear();
+	if (mSink == nullptr)
+		return;
 	
-	bool didLoadIcons = true;
+	mSink->CancelTimer(mMismatchTimer);
+	mMismatchTimer = 0;
+	mMismatchSlots[0] = kNoSlot;
+	mMismatchSlots[1] = kNoSlot;
 	
-	std::string pluginPath = ESDUtilities::GetPluginPath();
-	if (!pluginPath.empty())
-	{
-		// load tile icons
-		for (int i = 1; i < 16; i++)
-		{
-			std::string encodedFile;
-			bool couldLoad = GetEncodedIconStringFromFile(ESDUtilities::AddPathComponent(pluginPath, std::to_string(i) + ".png"), encodedFile);
-			if (couldLoad)
-			{
-				mIcons.push_back(encodedFile);
-			}
-			else
-			{
-				didLoadIcons = false;
-				DebugPrint("Could not load icon: %d.png\n", i);
-			}
-		}
-		//load reset icon
-		bool couldLoad = GetEncodedIconStringFromFile(ESDUtilities::AddPathComponent(pluginPath, "startover.png"), mResetIcon);
-		if (!couldLoad)
-		{
-			mResetIcon.clear();
-			didLoadIcons = false;
-			DebugPrint("Could not load icon: startover.png\n");
-		}
-	}
-
-	return didLoadIcons;
+	if (mSuccessAnimation)
+		mSuccessAnimation->Stop();
 }
 
 // Builds a list of pairs from all game tiles and assigns icons / titles to them.
 // These pairs have to be matched by the user.
 void MemoryGame::BuildActionPairs()
 {
-	auto actionList = GetAllGameActionsForDevice();
-	//mDistribution = std::uniform_int_distribution<int>(0, (int)actionList.size() - 1);
-
-	mAllGameTileContexts = actionList;
-	if (actionList.size() % 2 != 0)
+	ESDStringIDListPtr actionList = GetAllGameActionsForDevice();
+	mBoard.Reset(*actionList);
+	
+	if (actionList->size() % 2 != 0)
 	{
-		DebugPrint("actionList has wrong size %ld\n", actionList.size());
-		actionList.pop_back(); // remove last action to get even number for pairs		
+		DebugPrint("actionList has wrong size %ld\n", actionList->size());
 	}
-
-	int iconCaption = (int)mIcons.size();
-	while (!actionList.empty())
+	
+	size_t pairCount = mBoard.DealPairs(mRandom);
+	
+	// Pick a different icon for each face by shuffling the front of the icon list (partial Fisher-Yates).
+	// The faces after the last icon are shown as titles.
+	size_t iconCount = std::min(pairCount, mIcons.size());
+	for (size_t face = 0; face < iconCount; face++)
 	{
-		std::string context1 = actionList[actionList.size() - 1];
-		actionList.pop_back();
-		int index = mDistribution(sRandomNumberGenerator) % actionList.size();
-		std::string context2 = actionList[index];
-		actionList.erase(actionList.begin() + index);
-		mUnfinishedPairs[context1] = context2;
-		mUnfinishedPairs[context2] = context1;	
-
-		if (!mIcons.empty())
-		{
-			int iconIndex = mDistribution(sRandomNumberGenerator) % mIcons.size();
-			mIconsForContexts[context1] = mIcons[iconIndex];
-			mIconsForContexts[context2] = mIcons[iconIndex];
-			mIcons.erase(mIcons.begin() + iconIndex);
-		}
-		else
+		std::swap(mIcons[face], mIcons[face + mRandom.NextBelow((uint32_t)(mIcons.size() - face))]);
+		mFaceIcons.push_back(mIcons[face]);
+	}
+	
+	// pre-render the reveal messages, so a key press only has to send them
+	if (mSink != nullptr)
+	{
+		for (size_t slot = 0; slot < mBoard.GetSlotCount(); slot++)
 		{
-			mTitlesForContexts[context1] = std::to_string(iconCaption);
-			mTitlesForContexts[context2] = std::to_string(iconCaption);
-			iconCaption++;
+			const GameIcon* icon = GetIconForSlot((BoardSlot)slot);
+			if (icon != nullptr)
+				mSink->PrepareImage(icon->mId, icon->mBase64Image, icon->mBase64ImageSize, mBoard.GetContext((BoardSlot)slot));
 		}
 	}
 }
 
-void MemoryGame::ClearKeys(const std::vector<std::string>& inContexts) 
+void MemoryGame::ClearKeys(const std::vector<ESDStringID>& inContexts) 
 {
-	if (mMemoryGamePlugin != nullptr)
-		mMemoryGamePlugin->ClearKeys(inContexts);
+	if (mSink != nullptr)
+		mSink->ClearKeys(inContexts);
 }
 
-std::vector<std::string> MemoryGame::GetAllGameActionsForDevice()
+ESDStringIDListPtr MemoryGame::GetAllGameActionsForDevice()
 {
-	if (mMemoryGamePlugin != nullptr && !mDeviceId.empty())
+	if (mSink != nullptr && mDeviceId != kESDNoStringID)
 	{
-		return mMemoryGamePlugin->GetAllGameActionsForDevice(mDeviceId);
+		return mSink->GetAllGameActionsForDevice(mDeviceId);
 	}
 	
-	return std::vector<std::string>();
+	return GetNoContexts();
 }
 
-std::vector<std::string> MemoryGame::GetAllResetTilesForDevice()
+ESDStringIDListPtr MemoryGame::GetAllResetTilesForDevice()
 {
-	if (mMemoryGamePlugin != nullptr && !mDeviceId.empty())
+	if (mSink != nullptr && mDeviceId != kESDNoStringID)
 	{
-		return mMemoryGamePlugin->GetAllResetTilesForDevice(mDeviceId);
+		return mSink->GetAllResetTilesForDevice(mDeviceId);
 	}
 	
-	return std::vector<std::string>();
-}
-
-// Helper method, reads file into base64 encoded string
-bool MemoryGame::GetEncodedIconStringFromFile(const std::string& inName, std::string& outFileString)
-{
-	bool success = false;
-	std::ifstream pngFile(inName, std::ios::binary | std::ios::ate);
-	if (pngFile.is_open())
-	{
-		std::ifstream::pos_type pos = pngFile.tellg();
-
-		std::vector<char> result(pos);
-
-		pngFile.seekg(0, std::ios::beg);
-		pngFile.read(&result[0], pos);
-
-		std::string base64encodedImage = cppcodec::base64_rfc4648::encode(&result[0], result.size());
-		outFileString = base64encodedImage;
-		success = true;
-	}
-	else
-	{
-		success = false;
-		DebugPrint("Could not load icon: %s", inName.c_str());
-	}
-	return success;
+	return GetNoContexts();
 }
-
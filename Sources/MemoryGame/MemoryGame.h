@@ -12,75 +12,117 @@
 
 #pragma once
 
-#include <deque>
-#include <random>
+#include "GameSink.h"
+#include "MemoryBoard.h"
+#include "GameSession.h"
 
-class MyStreamDeckPlugin;
+#include <chrono>
+#include <memory>
 
-// Class with the actual game logic
+class ESDAnimationPlayer;
+
+// Class with the actual game logic, played on the keys provided by the sink
 class MemoryGame
 {
 public:
 
-	MemoryGame(MyStreamDeckPlugin* inPlugin, const std::string& inDeviceId);
+	MemoryGame(GameSink* inSink, ESDStringID inDeviceId);
 	~MemoryGame();
 
 	// Initializes the game, resets all lists etc
 	void InitGame();
+	// Seeds the deals of the following InitGame() calls, the same seed deals the same boards
+	void SetRandomSeed(uint64_t inSeed);
 	
-	// Handling key presses for game tiles.
-	void HandleMemoryTilePressed(const std::string& inContext);
+	// Handling key presses for game tiles and reset tiles. A key press stops a running replay.
+	void HandleMemoryTilePressed(ESDStringID inContext);
+	void HandleResetPressed();
 	
 	// Lets the title "Solved" flash on the keys and resets the game
-	void ShowSuccessAnimationAndRestart(const std::vector<std::string>& inContexts);
+	void ShowSuccessAnimationAndRestart(const std::vector<ESDStringID>& inContexts);
+	
+	// The deals and presses since the game was created or since the last replay started
+	const GameSession& GetSession() const { return mSession; }
+	
+	// Plays a recorded session on this game, each event at its recorded time or all of them at once.
+	// The replayed events are recorded again with their recorded times.
+	void Replay(const GameSession& inSession, bool inAsFastAsPossible);
+	void StopReplay();
+	bool IsReplaying() const { return mReplaying; }
 
 private:
 
-	bool ContextHasIcon(const std::string& inContext) const;
-	bool ContextHasTitle(const std::string& inContext) const;
+	bool SlotHasIcon(BoardSlot inSlot) const;
+	bool SlotHasTitle(BoardSlot inSlot) const;
 
-	std::string GetEncodedIconForContext(const std::string& inContext);
-	std::string GetHelperTitleForContext(const std::string& inContext);
+	const GameIcon* GetIconForSlot(BoardSlot inSlot) const;
+	std::string GetHelperTitleForSlot(BoardSlot inSlot) const;
 
 	// Methods to display or hide icons / titles on the keys
-	void SendRevealContext(const std::string& inContext);
-	void SendHideContext(const std::string& inContext);
-	void SendSolvedContext(const std::string& inContext);
-	void ClearKeys(const std::vector<std::string>& inContexts);
+	void SendIconForSlot(BoardSlot inSlot);
+	void SendRevealSlot(BoardSlot inSlot);
+	void SendHideSlot(BoardSlot inSlot);
+	void SendSolvedSlot(BoardSlot inSlot);
+	void ClearKeys(const std::vector<ESDStringID>& inContexts);
+
+	// Deals a new board with the seed and records it
+	void DealGame(GameSessionEventType inType, uint64_t inSeed);
+	void PressSlot(BoardSlot inSlot);
+	
+	void RecordEvent(GameSessionEventType inType, uint64_t inValue);
+	std::chrono::steady_clock::time_point GetTime() const;
+	uint32_t GetSessionTimeMs() const;
+	
+	void HandleReplayEvent(const GameSessionEvent& inEvent);
+	// Handles the replayed events that are due and waits for the next one
+	void ContinueReplay();
 
-	// Loads all game icons and the reset icon and store them in base 64 encoded strings
-	bool LoadIcons();
 	// Builds the pairs of keys to be matched by the user
 	void BuildActionPairs();
-	// Waits for all animations to finish
-	void JoinAllAnimationTimers();
-
-	static bool GetEncodedIconStringFromFile(const std::string& inName, std::string& outFileString);
+	// Hides the keys of the last mismatch if they are still displayed
+	void HideMismatch();
+	// Stops the running animations, their handlers are not called anymore
+	void CancelAllAnimationTimers();
 
 	// Used to get the contexts for the game and reset actions
-	std::vector<std::string> GetAllGameActionsForDevice();
-	std::vector<std::string> GetAllResetTilesForDevice();
+	ESDStringIDListPtr GetAllGameActionsForDevice();
+	ESDStringIDListPtr GetAllResetTilesForDevice();
 
-	std::vector<std::string>			mAllGameTileContexts;
-	std::map<std::string, std::string>  mUnfinishedPairs;
-	std::set<std::string>				mFinishedContexts;
+	MemoryBoard							mBoard;
 
-	std::map<std::string, std::string>	mIconsForContexts;
-	std::map<std::string, std::string>	mTitlesForContexts; // if not enough icons are loaded
+	// Icons of the faces of the pairs, point into the IconStore, which outlives the games.
+	// The faces after the last icon are shown as titles, if not enough icons are loaded.
+	std::vector<const GameIcon*>		mFaceIcons;
 
-	std::string							mCurrentRevealedContext;
+	BoardSlot							mRevealedSlot = kNoSlot;
 
-	std::deque<std::thread*>			mDisplayHelperTimers;
+	// Keys of the last mismatch, hidden by mMismatchTimer or by the next key press
+	BoardSlot							mMismatchSlots[2] = { kNoSlot, kNoSlot };
+	ESDTimerID							mMismatchTimer = 0;
+	std::unique_ptr<ESDAnimationPlayer>	mSuccessAnimation;
 
-	std::vector<std::string>			mIcons;
+	// Icons to deal from, shuffled in place
+	std::vector<const GameIcon*>		mIcons;
 
-	std::vector<std::string>			mResetTileContexts;
-	std::string							mResetIcon;
-	bool								mStopDisplayingMismatch = false;
-	std::string							mDeviceId;
-	MyStreamDeckPlugin*					mMemoryGamePlugin = nullptr;
+	// Shared with the sink, never nullptr
+	ESDStringIDListPtr					mResetTileContexts;
+	const GameIcon*						mResetIcon = nullptr;
+	ESDStringID							mDeviceId = kESDNoStringID;
+	GameSink*							mSink = nullptr;
 
-	std::uniform_int_distribution<int>	mDistribution;
-	static std::default_random_engine	sRandomNumberGenerator;
+	// Owned by the game, the games re-initialize on the strands of their devices concurrently.
+	// mSeedRandom draws the seed of each deal, mRandom is seeded with it and deals the board.
+	GameRandom							mSeedRandom;
+	GameRandom							mRandom;
+	
+	GameSession							mSession;
+	std::chrono::steady_clock::time_point	mSessionStart;
+	
+	// The session being replayed, mNextReplayEvent is the event handled or waited for
+	std::vector<GameSessionEvent>		mReplayEvents;
+	size_t								mNextReplayEvent = 0;
+	uint32_t							mReplayStartTimeMs = 0;
+	ESDTimerID							mReplayTimer = 0;
+	bool								mReplaying = false;
 };
 
@@ -13,7 +13,7 @@
 #include "StreamDeckAction.h"
 
 
-StreamDeckAction::StreamDeckAction(const std::string& inContext, const std::string& inDeviceId, const std::string& inActionType)
+StreamDeckAction::StreamDeckAction(ESDStringID inContext, ESDStringID inDeviceId, ESDStringID inActionType)
 {
 	mContext = inContext;
 	mDeviceId = inDeviceId;
@@ -22,6 +22,24 @@ StreamDeckAction::StreamDeckAction(const std::string& inContext, const std::stri
 
 bool StreamDeckAction::IsValid() const
 {
-	return !mContext.empty() && !mDeviceId.empty() && (mActionType == kActionNameReset || mActionType == kActionNameTile || mActionType == kActionNameNone);
+	return mContext != kESDNoStringID && mDeviceId != kESDNoStringID && (mActionType == GetResetType() || mActionType == GetTileType() || mActionType == GetNoneType());
+}
+
+ESDStringID StreamDeckAction::GetTileType()
+{
+	static const ESDStringID sTileType = ESDStringInterner::Get().Intern(kActionNameTile);
+	return sTileType;
+}
+
+ESDStringID StreamDeckAction::GetResetType()
+{
+	static const ESDStringID sResetType = ESDStringInterner::Get().Intern(kActionNameReset);
+	return sResetType;
+}
+
+ESDStringID StreamDeckAction::GetNoneType()
+{
+	static const ESDStringID sNoneType = ESDStringInterner::Get().Intern(kActionNameNone);
+	return sNoneType;
 }
 
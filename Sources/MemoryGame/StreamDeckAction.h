@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include "../Common/ESDStringInterner.h"
 
 #define kActionNameTile  "com.elgato.memorygame.tile"
 #define kActionNameReset "com.elgato.memorygame.reset"
@@ -20,20 +21,26 @@
 class StreamDeckAction 
 {
 public:
-	std::string mContext;
-	std::string mDeviceId;
-	std::string mActionType;
+	ESDStringID mContext = kESDNoStringID;
+	ESDStringID mDeviceId = kESDNoStringID;
+	ESDStringID mActionType = kESDNoStringID;
 
-	StreamDeckAction(const std::string& inContext, const std::string& inDeviceId, const std::string& inActionType);
+	StreamDeckAction(ESDStringID inContext, ESDStringID inDeviceId, ESDStringID inActionType);
 
 	bool IsValid() const;
+
+	// Interned action names, to compare with mActionType
+	static ESDStringID GetTileType();
+	static ESDStringID GetResetType();
+	static ESDStringID GetNoneType();
 };
 
+// Orders by context, then device, then action type
 inline bool operator< (const StreamDeckAction& inLhs, const StreamDeckAction& inRhs)
 {
 	if (inLhs.mContext != inRhs.mContext)
 		return inLhs.mContext < inRhs.mContext;
-	else if (inLhs.mDeviceId < inRhs.mDeviceId)
+	if (inLhs.mDeviceId != inRhs.mDeviceId)
 		return inLhs.mDeviceId < inRhs.mDeviceId;
 	return inLhs.mActionType < inRhs.mActionType;
 }
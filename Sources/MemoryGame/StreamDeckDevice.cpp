@@ -17,7 +17,7 @@
 
 StreamDeckDevice::StreamDeckDevice() {}
 
-StreamDeckDevice::StreamDeckDevice(const std::string& inDeviceId, const json& inDeviceInfo)
+StreamDeckDevice::StreamDeckDevice(ESDStringID inDeviceId, const json& inDeviceInfo)
 {
 	mRows = -1;
 	mColumns = -1;
@@ -36,7 +36,7 @@ StreamDeckDevice::StreamDeckDevice(const std::string& inDeviceId, const json& in
 	}
 }
 
-StreamDeckDevice::StreamDeckDevice(const std::string& inDeviceId, int inRows, int inColumns)
+StreamDeckDevice::StreamDeckDevice(ESDStringID inDeviceId, int inRows, int inColumns)
 {
 	mDeviceId = inDeviceId;
 	mRows = inRows;
@@ -50,5 +50,5 @@ int StreamDeckDevice::Size() const
 
 bool StreamDeckDevice::IsValid() const
 {
-	return !mDeviceId.empty() && mColumns > 0 && mRows > 0;
+	return mDeviceId != kESDNoStringID && mColumns > 0 && mRows > 0;
 }
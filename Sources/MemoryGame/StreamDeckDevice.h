@@ -12,17 +12,19 @@
 
 #pragma once
 
+#include "../Common/ESDStringInterner.h"
+
 class StreamDeckDevice 
 {
 public:
 
-	std::string mDeviceId;
+	ESDStringID mDeviceId = kESDNoStringID;
 	int mRows = -1;
 	int mColumns = -1;
 		
 	StreamDeckDevice();
-	StreamDeckDevice(const std::string& inDeviceId, const json& inDeviceInfo);
-	StreamDeckDevice(const std::string& inDeviceId, int inRows, int inColumns);
+	StreamDeckDevice(ESDStringID inDeviceId, const json& inDeviceInfo);
+	StreamDeckDevice(ESDStringID inDeviceId, int inRows, int inColumns);
 		
 	int Size() const;
 
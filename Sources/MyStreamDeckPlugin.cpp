@@ -13,10 +13,40 @@
 #include "MyStreamDeckPlugin.h"
 #include "Common/ESDConnectionManager.h"
 #include "ESDLocalizer.h"
+#include "IconStore.h"
+
+#ifdef __APPLE__
+	#include "macOS/PlatformSpecific.h"
+#else
+	#include "Windows/PlatformSpecific.h"
+#endif
+
+#include <algorithm>
+
+// sendToPlugin payload key requesting the latency report. In debug builds the value is the path of the file to
+// write it to, if it is empty the report is written to the Stream Deck log. Release builds always write it to
+// the log, they do not write to a path from a payload.
+#define kPayloadDumpLatencyReport "dumpLatencyReport"
+#if DEBUG
+// sendToPlugin payload keys to write the recorded session of the game of the action to a file, and to replay
+// a session from a file on it. The replay runs at the recorded speed, or as fast as possible if
+// kPayloadReplayAsFastAsPossible is true. Debug builds only, they read and write any path they are given.
+#define kPayloadDumpGameSession "dumpGameSession"
+#define kPayloadReplayGameSession "replayGameSession"
+#define kPayloadReplayAsFastAsPossible "replayAsFastAsPossible"
+#endif
+
+// The game of a device is started when no key event arrived for twice the longest gap between the events of
+// the burst loading the profile, within these bounds
+#define kSettleMinWindowMs 5
+#define kSettleMaxWindowMs 100
 
 MyStreamDeckPlugin::MyStreamDeckPlugin()
 {
 	mActionManager = new ActionManager(this);
+	
+	// Load the icons before the first game needs them
+	IconStore::Get();
 }
 
 MyStreamDeckPlugin::~MyStreamDeckPlugin()
@@ -24,132 +54,347 @@ MyStreamDeckPlugin::~MyStreamDeckPlugin()
 	delete mActionManager;
 }
 
-void MyStreamDeckPlugin::KeyDownForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID)
+void MyStreamDeckPlugin::KeyDownForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID)
 {
 	// Nothing to do
 }
 
-void MyStreamDeckPlugin::KeyUpForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID)
+void MyStreamDeckPlugin::KeyUpForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID)
 {
 	// if the key belongs to a game, handle it
-	if (mGames.find(inDeviceID) != mGames.end())
+	MemoryGame* game = GetGameForDevice(inDeviceID);
+	if (game != nullptr)
 	{
-		if (inAction == kActionNameTile)
+		if (inAction == StreamDeckAction::GetTileType())
 		{
-			mGames[inDeviceID]->HandleMemoryTilePressed(inContext);
+			game->HandleMemoryTilePressed(inContext);
 		}
-		else if (inAction == kActionNameReset)
+		else if (inAction == StreamDeckAction::GetResetType())
 		{
-			mGames[inDeviceID]->InitGame();
+			game->HandleResetPressed();
 		}
-		else if (inAction == kActionNameNone)
+		else if (inAction == StreamDeckAction::GetNoneType())
 		{
 			// Nothing to do
 		}
 	}
 }
 
-void MyStreamDeckPlugin::WillAppearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID)
+void MyStreamDeckPlugin::WillAppearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID)
 {
+	NoteActionEvent(inDeviceID);
 	if (mActionManager != nullptr)
 		mActionManager->AddAction(StreamDeckAction(inContext, inDeviceID, inAction));
 }
 
-void MyStreamDeckPlugin::WillDisappearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID)
+void MyStreamDeckPlugin::WillDisappearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID)
 {
+	NoteActionEvent(inDeviceID);
 	if (mActionManager != nullptr)
 		mActionManager->RemoveAction(StreamDeckAction(inContext, inDeviceID, inAction));
 }
 
-void MyStreamDeckPlugin::DeviceDidConnect(const std::string& inDeviceID, const json &inDeviceInfo)
+void MyStreamDeckPlugin::DeviceDidConnect(ESDStringID inDeviceID, const json &inDeviceInfo)
 {
 	if (mActionManager != nullptr)
 		mActionManager->AddDevice(StreamDeckDevice(inDeviceID, inDeviceInfo));
 }
 
-void MyStreamDeckPlugin::DeviceDidDisconnect(const std::string& inDeviceID)
+void MyStreamDeckPlugin::DeviceDidDisconnect(ESDStringID inDeviceID)
 {
 	if (mActionManager != nullptr)
 		mActionManager->RemoveDevice(inDeviceID);
 	// remove game
-	if (mGames.find(inDeviceID) != mGames.end())
+	CancelGameStart(inDeviceID);
+	RemoveGameForDevice(inDeviceID);
+	
+	std::lock_guard<std::mutex> lock(mGamesMutex);
+	mSettles.erase(inDeviceID);
+}
+
+void MyStreamDeckPlugin::SendToPlugin(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID)
+{
+	if (mConnectionManager != nullptr && inPayload.is_object() && inPayload.find(kPayloadDumpLatencyReport) != inPayload.end())
 	{
-		if(mGames[inDeviceID] != nullptr)
-		{
-			delete mGames[inDeviceID];
-		}
+#if DEBUG
+		std::string path = EPLJSONUtils::GetStringByName(inPayload, kPayloadDumpLatencyReport);
+		if (path.empty() || !mConnectionManager->WriteLatencyReport(path))
+			mConnectionManager->LogLatencyReport();
+#else
+		mConnectionManager->LogLatencyReport();
+#endif
+	}
+	
+#if DEBUG
+	if (mConnectionManager != nullptr && mActionManager != nullptr && inPayload.is_object())
+	{
+		// sendToPlugin has no device, the game is found by the action sending it
+		ESDStringID deviceId = mActionManager->GetDeviceIdForContext(inContext);
 		
-		mGames.erase(inDeviceID);
+		if (inPayload.find(kPayloadDumpGameSession) != inPayload.end())
+			DumpGameSession(deviceId, EPLJSONUtils::GetStringByName(inPayload, kPayloadDumpGameSession));
+		
+		if (inPayload.find(kPayloadReplayGameSession) != inPayload.end())
+			ReplayGameSession(deviceId, EPLJSONUtils::GetStringByName(inPayload, kPayloadReplayGameSession), EPLJSONUtils::GetBoolByName(inPayload, kPayloadReplayAsFastAsPossible));
 	}
+#endif
 }
 
-void MyStreamDeckPlugin::SendToPlugin(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID)
+#if DEBUG
+
+void MyStreamDeckPlugin::DumpGameSession(ESDStringID inDeviceId, const std::string& inPath)
 {
-	// Nothing to do
+	// The session is only used on the strand of the device
+	mConnectionManager->PostToDevice(inDeviceId, [this, inDeviceId, inPath]()
+	{
+		MemoryGame* game = GetGameForDevice(inDeviceId);
+		if (game == nullptr || !game->GetSession().WriteToFile(inPath))
+			mConnectionManager->LogMessage("Could not write the game session to " + inPath);
+	});
 }
 
-void MyStreamDeckPlugin::SetTitle(const std::string& inTitle, const std::string& inContext) 
+void MyStreamDeckPlugin::ReplayGameSession(ESDStringID inDeviceId, const std::string& inPath, bool inAsFastAsPossible)
+{
+	std::shared_ptr<GameSession> session = std::make_shared<GameSession>();
+	if (!session->ReadFromFile(inPath))
+	{
+		mConnectionManager->LogMessage("Could not read the game session from " + inPath);
+		return;
+	}
+	
+	mConnectionManager->PostToDevice(inDeviceId, [this, inDeviceId, session, inAsFastAsPossible]()
+	{
+		MemoryGame* game = GetGameForDevice(inDeviceId);
+		if (game == nullptr)
+			return;
+		
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		game->Replay(*session, inAsFastAsPossible);
+		if (inAsFastAsPossible)
+		{
+			long long durationUs = (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+			mConnectionManager->LogMessage("Replayed " + std::to_string(session->GetEvents().size()) + " game events in " + std::to_string(durationUs) + " us");
+		}
+	});
+}
+
+#endif
+
+bool MyStreamDeckPlugin::NeedsPayloadForEvent(ESDSDKEventType inEventType)
+{
+	// Only sendToPlugin uses its payload
+	return inEventType == kESDSDKEventType_SendToPlugin;
+}
+
+void MyStreamDeckPlugin::SetTitle(const std::string& inTitle, ESDStringID inContext) 
 {
 	if (mConnectionManager != nullptr)
 		mConnectionManager->SetTitle(inTitle, inContext, kESDSDKTarget_HardwareAndSoftware);
 }
 
-void MyStreamDeckPlugin::SetImage(const std::string& inImage, const std::string& inContext) 
+void MyStreamDeckPlugin::SetImage(const std::string& inImage, ESDStringID inContext) 
 {
 	if (mConnectionManager != nullptr)
 		mConnectionManager->SetImage(inImage, inContext, kESDSDKTarget_HardwareAndSoftware);
 }
 
-void MyStreamDeckPlugin::ClearKeys(const std::vector<std::string>& inContexts)
+void MyStreamDeckPlugin::PrepareImage(const std::string& inImageId, const char* inImage, size_t inImageSize, ESDStringID inContext)
 {
+	if (mConnectionManager != nullptr)
+		mConnectionManager->PrepareImage(inImageId, inImage, inImageSize, inContext, kESDSDKTarget_HardwareAndSoftware);
+}
+
+bool MyStreamDeckPlugin::SetPreparedImage(const std::string& inImageId, ESDStringID inContext)
+{
+	if (mConnectionManager != nullptr)
+		return mConnectionManager->SetPreparedImage(inImageId, inContext, kESDSDKTarget_HardwareAndSoftware);
+	return false;
+}
+
+void MyStreamDeckPlugin::ClearKeys(const std::vector<ESDStringID>& inContexts)
+{
+	if (mConnectionManager == nullptr)
+		return;
+	
+	// delete titles + icons of all keys in one batch
+	std::vector<ESDKeyChange> changes;
+	changes.reserve(2 * inContexts.size());
 	for (const auto& context : inContexts)
 	{
-		// delete titles + icons
-		SetTitle("", context);
-		SetImage("", context);
+		ESDKeyChange change;
+		change.mContext = context;
+		change.mIsImage = false;
+		changes.push_back(change);
+		change.mIsImage = true;
+		changes.push_back(change);
 	}
+	mConnectionManager->SetKeys(changes);
+}
+
+void MyStreamDeckPlugin::SetKeys(const std::vector<ESDKeyChange>& inChanges)
+{
+	if (mConnectionManager != nullptr)
+		mConnectionManager->SetKeys(inChanges);
 }
 
-std::vector<std::string> MyStreamDeckPlugin::GetAllGameActionsForDevice(const std::string& inDeviceId)
+ESDTimerID MyStreamDeckPlugin::StartTimer(ESDStringID inDeviceId, int inDelayMs, const std::function<void()>& inHandler)
 {
-	return GetAllActionsOfTypeForDevice(inDeviceId, kActionNameTile);
+	if (mConnectionManager != nullptr)
+		return mConnectionManager->StartTimer(inDeviceId, inDelayMs, inHandler);
+	return 0;
 }
 
-std::vector<std::string> MyStreamDeckPlugin::GetAllResetTilesForDevice(const std::string& inDeviceId)
+void MyStreamDeckPlugin::CancelTimer(ESDTimerID inTimerID)
 {
-	return GetAllActionsOfTypeForDevice(inDeviceId, kActionNameReset);
+	if (mConnectionManager != nullptr && inTimerID != 0)
+		mConnectionManager->CancelTimer(inTimerID);
 }
 
-std::vector<std::string> MyStreamDeckPlugin::GetAllActionsOfTypeForDevice(const std::string& inDeviceId, const std::string& inType)
+const std::vector<GameIcon>& MyStreamDeckPlugin::GetTileIcons()
 {
-	std::vector<std::string> ret;
+	// the icons were loaded once for all games
+	const IconStore& iconStore = IconStore::Get();
+	if (iconStore.IsComplete())
+		return iconStore.GetTileIcons();
+	
+	DebugPrint("Something went wrong when loading icons, use titles instead.\n");
+	static const std::vector<GameIcon> sNoIcons;
+	return sNoIcons;
+}
+
+const GameIcon* MyStreamDeckPlugin::GetResetIcon()
+{
+	return IconStore::Get().GetResetIcon();
+}
+
+std::string MyStreamDeckPlugin::GetLocalizedString(const std::string& inDefaultString)
+{
+	return ESDLocalizer::GetLocalizedString(inDefaultString);
+}
+
+void MyStreamDeckPlugin::PlaySoundGameFinished()
+{
+	PlatformSpecific::PlaySoundGameFinished();
+}
+
+ESDStringIDListPtr MyStreamDeckPlugin::GetAllGameActionsForDevice(ESDStringID inDeviceId)
+{
+	return GetAllActionsOfTypeForDevice(inDeviceId, StreamDeckAction::GetTileType());
+}
+
+ESDStringIDListPtr MyStreamDeckPlugin::GetAllResetTilesForDevice(ESDStringID inDeviceId)
+{
+	return GetAllActionsOfTypeForDevice(inDeviceId, StreamDeckAction::GetResetType());
+}
+
+ESDStringIDListPtr MyStreamDeckPlugin::GetAllActionsOfTypeForDevice(ESDStringID inDeviceId, ESDStringID inType)
+{
+	// The list is indexed by device and type and stays valid while it is held
 	if (mActionManager != nullptr)
+		return mActionManager->GetContextsForDevice(inDeviceId, inType);
+	return std::make_shared<const ESDStringIDList>();
+}
+
+void MyStreamDeckPlugin::ActionOfActiveDeviceDisappeared(ESDStringID inDeviceId, ESDStringID inContext) 
+{
+	CancelGameStart(inDeviceId);
+	RemoveGameForDevice(inDeviceId);
+}
+
+void MyStreamDeckPlugin::ProfileLoadedForDevice(ESDStringID inDeviceId)
+{
+	std::unique_lock<std::mutex> lock(mGamesMutex);
+	if (mGames.find(inDeviceId) != mGames.end())
+		return;
+	
+	// Every further event of the burst moves the start of the game
+	DeviceSettle& settle = mSettles[inDeviceId];
+	CancelTimer(settle.mStartTimer);
+	settle.mStartTimer = StartTimer(inDeviceId, GetSettleWindowMs(settle), [this, inDeviceId]()
+	{
+		StartGameForDevice(inDeviceId);
+	});
+	
+	// Without a connection there are no timers
+	if (settle.mStartTimer == 0)
 	{
-		auto allActions = mActionManager->GetAllGameActionsForDevice(inDeviceId);
-		for (auto action : allActions)
-			if (action.mActionType == inType)
-				ret.push_back(action.mContext);
+		lock.unlock();
+		StartGameForDevice(inDeviceId);
 	}
-	return ret;
 }
 
-void MyStreamDeckPlugin::ActionOfActiveDeviceDisappeared(const std::string& inDeviceId, const std::string& inContext) 
+void MyStreamDeckPlugin::NoteActionEvent(ESDStringID inDeviceId)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	
+	std::lock_guard<std::mutex> lock(mGamesMutex);
+	DeviceSettle& settle = mSettles[inDeviceId];
+	int gapMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - settle.mLastEventTime).count();
+	
+	// An event after the window of the burst so far elapsed starts a new burst
+	if (settle.mLastEventTime == std::chrono::steady_clock::time_point() || gapMs > GetSettleWindowMs(settle))
+		settle.mLongestGapMs = 0;
+	else
+		settle.mLongestGapMs = std::max(settle.mLongestGapMs, gapMs);
+	settle.mLastEventTime = now;
+}
+
+int MyStreamDeckPlugin::GetSettleWindowMs(const DeviceSettle& inSettle)
+{
+	return std::min(std::max(2 * inSettle.mLongestGapMs, kSettleMinWindowMs), kSettleMaxWindowMs);
+}
+
+void MyStreamDeckPlugin::StartGameForDevice(ESDStringID inDeviceId)
 {
-	if (mGames.find(inDeviceId) != mGames.end())
 	{
-		if(mGames[inDeviceId] != nullptr)
-		{
-			delete mGames[inDeviceId];
-		}
-		
-		mGames.erase(inDeviceId);
+		std::lock_guard<std::mutex> lock(mGamesMutex);
+		auto it = mSettles.find(inDeviceId);
+		if (it != mSettles.end())
+			it->second.mStartTimer = 0;
+		if (mGames.find(inDeviceId) != mGames.end())
+			return;
+	}
+	
+	// The game displays its keys when it is created, so do it outside of the lock
+	MemoryGame* game = new MemoryGame(this, inDeviceId);
+	
+	std::lock_guard<std::mutex> lock(mGamesMutex);
+	mGames[inDeviceId] = game;
+}
+
+void MyStreamDeckPlugin::CancelGameStart(ESDStringID inDeviceId)
+{
+	std::lock_guard<std::mutex> lock(mGamesMutex);
+	auto it = mSettles.find(inDeviceId);
+	if (it != mSettles.end())
+	{
+		CancelTimer(it->second.mStartTimer);
+		it->second.mStartTimer = 0;
 	}
 }
 
-void MyStreamDeckPlugin::ProfileLoadedForDevice(const std::string& inDeviceId)
+MemoryGame* MyStreamDeckPlugin::GetGameForDevice(ESDStringID inDeviceId)
+{
+	std::lock_guard<std::mutex> lock(mGamesMutex);
+	auto it = mGames.find(inDeviceId);
+	return it != mGames.end() ? it->second : nullptr;
+}
+
+void MyStreamDeckPlugin::RemoveGameForDevice(ESDStringID inDeviceId)
 {
-	if (mGames.find(inDeviceId) == mGames.end())
+	MemoryGame* game = nullptr;
+	
 	{
-		mGames[inDeviceId] = new MemoryGame(this, inDeviceId);
+		std::lock_guard<std::mutex> lock(mGamesMutex);
+		auto it = mGames.find(inDeviceId);
+		if (it == mGames.end())
+			return;
+		game = it->second;
+		mGames.erase(it);
 	}
+	
+	// The destructor cancels the mismatch, success animation and replay timers of the game. Every caller runs on
+	// the strand of the device like these timers, so none of them can be running, and a cancelled timer that
+	// already expired finds itself removed and does not call the deleted game.
+	delete game;
 }
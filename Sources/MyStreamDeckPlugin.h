@@ -13,43 +13,95 @@
 
 #include "Common/ESDBasePlugin.h"
 #include "MemoryGame.h"
+#include "GameSink.h"
 #include "ActionManager.h"
 
-class MyStreamDeckPlugin : public ESDBasePlugin
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+class MyStreamDeckPlugin : public ESDBasePlugin, public GameSink, public ActionManagerListener
 {
 public:
 	
 	MyStreamDeckPlugin();
 	virtual ~MyStreamDeckPlugin();
 	
-	void KeyDownForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) override;
-	void KeyUpForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) override;
+	void KeyDownForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) override;
+	void KeyUpForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) override;
+	
+	void WillAppearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) override;
+	void WillDisappearForAction(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) override;
 	
-	void WillAppearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) override;
-	void WillDisappearForAction(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) override;
+	void DeviceDidConnect(ESDStringID inDeviceID, const json &inDeviceInfo) override;
+	void DeviceDidDisconnect(ESDStringID inDeviceID) override;
 	
-	void DeviceDidConnect(const std::string& inDeviceID, const json &inDeviceInfo) override;
-	void DeviceDidDisconnect(const std::string& inDeviceID) override;
+	void SendToPlugin(ESDStringID inAction, ESDStringID inContext, const json &inPayload, ESDStringID inDeviceID) override;
 	
-	void SendToPlugin(const std::string& inAction, const std::string& inContext, const json &inPayload, const std::string& inDeviceID) override;
+	bool NeedsPayloadForEvent(ESDSDKEventType inEventType) override;
 
 	// Helpers to allow the games to display images / titles or clear the keys
-	void SetTitle(const std::string& inTitle, const std::string& inContext);
-	void SetImage(const std::string& inImage, const std::string& inContext);
-	void ClearKeys(const std::vector<std::string>& inContexts);
+	void SetTitle(const std::string& inTitle, ESDStringID inContext) override;
+	void SetImage(const std::string& inImage, ESDStringID inContext) override;
+	// Helpers to pre-render the image of a key once and display it later without rebuilding the message
+	void PrepareImage(const std::string& inImageId, const char* inImage, size_t inImageSize, ESDStringID inContext) override;
+	bool SetPreparedImage(const std::string& inImageId, ESDStringID inContext) override;
+	void ClearKeys(const std::vector<ESDStringID>& inContexts) override;
+	void SetKeys(const std::vector<ESDKeyChange>& inChanges) override;
+	
+	// Runs a handler on the strand of the device after a delay, never concurrently with its events
+	ESDTimerID StartTimer(ESDStringID inDeviceId, int inDelayMs, const std::function<void()>& inHandler) override;
+	void CancelTimer(ESDTimerID inTimerID) override;
 
 	// Helpers for the games to get the keys belonging the its device
-	std::vector<std::string> GetAllGameActionsForDevice(const std::string& inDeviceId);
-	std::vector<std::string> GetAllResetTilesForDevice(const std::string& inDeviceId);
+	ESDStringIDListPtr GetAllGameActionsForDevice(ESDStringID inDeviceId) override;
+	ESDStringIDListPtr GetAllResetTilesForDevice(ESDStringID inDeviceId) override;
+	
+	// The icons of the IconStore, the localized strings and sounds of the platform
+	const std::vector<GameIcon>& GetTileIcons() override;
+	const GameIcon* GetResetIcon() override;
+	std::string GetLocalizedString(const std::string& inDefaultString) override;
+	void PlaySoundGameFinished() override;
 	
 	// Called if context belonging to ongoing game disapears. Removes game.
-	void ActionOfActiveDeviceDisappeared(const std::string& inDeviceId, const std::string& inContext);
-	// Called if profile was loaded, new game will be started on device
-	void ProfileLoadedForDevice(const std::string& inDeviceId);
+	void ActionOfActiveDeviceDisappeared(ESDStringID inDeviceId, ESDStringID inContext) override;
+	// Called if profile was loaded, new game will be started on device once the profile settled
+	void ProfileLoadedForDevice(ESDStringID inDeviceId) override;
 
 private:
-	std::vector<std::string> GetAllActionsOfTypeForDevice(const std::string& inDeviceId, const std::string& inType);
+	// The burst of key events of a device and the pending start of its game
+	struct DeviceSettle
+	{
+		ESDTimerID mStartTimer = 0;
+		std::chrono::steady_clock::time_point mLastEventTime;
+		int mLongestGapMs = 0;
+	};
+	
+#if DEBUG
+	// Write the recorded session of the game of the device to a file or replay one on it
+	void DumpGameSession(ESDStringID inDeviceId, const std::string& inPath);
+	void ReplayGameSession(ESDStringID inDeviceId, const std::string& inPath, bool inAsFastAsPossible);
+#endif
+	
+	ESDStringIDListPtr GetAllActionsOfTypeForDevice(ESDStringID inDeviceId, ESDStringID inType);
+	
+	// The keys of a profile appear as a burst of events. The game is started once the burst settled, see
+	// NoteActionEvent(), so keys that disappear and reappear while the profile loads do not deal several games.
+	void NoteActionEvent(ESDStringID inDeviceId);
+	void StartGameForDevice(ESDStringID inDeviceId);
+	void CancelGameStart(ESDStringID inDeviceId);
+	// How long no event of the burst must arrive before the game is started
+	static int GetSettleWindowMs(const DeviceSettle& inSettle);
+	
+	// Returns the game of the device, nullptr if there is none
+	MemoryGame* GetGameForDevice(ESDStringID inDeviceId);
+	// Removes the game of the device, must be called on the strand of the device
+	void RemoveGameForDevice(ESDStringID inDeviceId);
 
-	std::map<std::string, MemoryGame*> mGames;
+	// The events of different devices are handled concurrently, a game itself is only used by the events of its device
+	std::mutex mGamesMutex;
+	std::map<ESDStringID, MemoryGame*> mGames;
+	// The burst of key events of each device and the start of its game, guarded by mGamesMutex
+	std::map<ESDStringID, DeviceSettle> mSettles;
 	ActionManager* mActionManager = nullptr;
 };
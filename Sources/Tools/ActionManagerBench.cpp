@@ -0,0 +1,123 @@
+//==============================================================================
+/**
+@file       ActionManagerBench.cpp
+
+@brief      Measures the ActionManager reads while a writer keeps changing a profile
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+//
+// Usage: ActionManagerBench [seconds per run] [max reader count]
+//
+// Three XL devices with 32 tile keys each are connected. For 1, 2, 4, ... reader threads, the readers query
+// the tile contexts and the profile completeness of these devices, the reads of a key press and of a deal,
+// while one writer thread keeps loading and unloading a 32 key profile on a fourth device. Reports the reads
+// per second in total and per reader, and the adds and removes of the writer per second. Built from the
+// Sources folder with:
+//
+//   c++ -std=c++14 -O2 -include macOS/pch.h -I MemoryGame -I Common -o ActionManagerBench Tools/ActionManagerBench.cpp
+//       MemoryGame/ActionManager.cpp MemoryGame/StreamDeckAction.cpp MemoryGame/StreamDeckDevice.cpp
+//       Common/ESDStringInterner.cpp -pthread
+
+#include "../MemoryGame/ActionManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define kBenchKeyCount 32
+#define kBenchReadDeviceCount 3
+
+static void RunBench(int inReaderCount, double inSeconds)
+{
+	ESDStringInterner& interner = ESDStringInterner::Get();
+	const ESDStringID tileType = StreamDeckAction::GetTileType();
+
+	ActionManager actionManager(nullptr);
+	std::vector<ESDStringID> readDevices;
+	for (int device = 0; device < kBenchReadDeviceCount; device++)
+	{
+		ESDStringID deviceId = interner.Intern("bench-read-" + std::to_string(device));
+		readDevices.push_back(deviceId);
+		actionManager.AddDevice(StreamDeckDevice(deviceId, 4, 8));
+		for (int key = 0; key < kBenchKeyCount; key++)
+			actionManager.AddAction(StreamDeckAction(interner.Intern("bench-read-" + std::to_string(device) + "-" + std::to_string(key)), deviceId, tileType));
+	}
+
+	ESDStringID writeDevice = interner.Intern("bench-write");
+	actionManager.AddDevice(StreamDeckDevice(writeDevice, 4, 8));
+	std::vector<StreamDeckAction> writeActions;
+	for (int key = 0; key < kBenchKeyCount; key++)
+		writeActions.push_back(StreamDeckAction(interner.Intern("bench-write-" + std::to_string(key)), writeDevice, tileType));
+
+	std::atomic<bool> stop(false);
+	std::atomic<uint64_t> readCount(0);
+	std::atomic<uint64_t> writeCount(0);
+	std::vector<std::thread> threads;
+
+	for (int reader = 0; reader < inReaderCount; reader++)
+	{
+		threads.emplace_back([&]()
+		{
+			uint64_t reads = 0;
+			size_t checksum = 0;
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				ESDStringID deviceId = readDevices[reads % kBenchReadDeviceCount];
+				checksum += actionManager.GetContextsForDevice(deviceId, tileType)->size();
+				checksum += actionManager.IsCompleteProfileLoaded(deviceId) ? 1 : 0;
+				reads++;
+			}
+			readCount += reads;
+
+			// Keeps the reads from being optimized away
+			if (checksum == 0)
+				std::printf("no keys read\n");
+		});
+	}
+
+	threads.emplace_back([&]()
+	{
+		uint64_t writes = 0;
+		while (!stop.load(std::memory_order_relaxed))
+		{
+			for (const StreamDeckAction& action : writeActions)
+				actionManager.AddAction(action);
+			for (const StreamDeckAction& action : writeActions)
+				actionManager.RemoveAction(action);
+			writes += 2 * writeActions.size();
+		}
+		writeCount += writes;
+	});
+
+	std::this_thread::sleep_for(std::chrono::duration<double>(inSeconds));
+	stop = true;
+	for (std::thread& thread : threads)
+		thread.join();
+
+	const double readsPerSecond = (double)readCount / inSeconds;
+	std::printf("%7d %14.2f %14.2f %14.3f\n", inReaderCount, readsPerSecond / 1e6, readsPerSecond / 1e6 / inReaderCount,
+		(double)writeCount / inSeconds / 1e6);
+}
+
+int main(int argc, const char* argv[])
+{
+	const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+	const int maxReaderCount = argc > 2 ? std::atoi(argv[2]) : 8;
+	if (seconds <= 0.0 || maxReaderCount < 1)
+	{
+		std::fprintf(stderr, "The run time and the reader count must be positive\n");
+		return 1;
+	}
+
+	std::printf("%7s %14s %14s %14s\n", "readers", "M reads/s", "M per reader", "M writes/s");
+	for (int readerCount = 1; readerCount <= maxReaderCount; readerCount *= 2)
+		RunBench(readerCount, seconds);
+	return 0;
+}
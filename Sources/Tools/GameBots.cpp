@@ -0,0 +1,160 @@
+//==============================================================================
+/**
+@file       GameBots.cpp
+
+@brief      Scripted players for MemoryGame, to play full games on a HeadlessGameSink
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#include "GameBots.h"
+
+void PerfectMemoryBot::NewGame(size_t inTileCount)
+{
+	mTileCount = inTileCount;
+	mFaces.assign(inTileCount, std::string());
+	mKnown.assign(inTileCount, false);
+	mDone.assign(inTileCount, false);
+	mPlannedPresses.clear();
+	mTurnTile = inTileCount;
+}
+
+size_t PerfectMemoryBot::NextPress()
+{
+	if (mPlannedPresses.empty())
+	{
+		if (mTurnTile == mTileCount)
+		{
+			PlanTurn();
+		}
+		else
+		{
+			// Second press of a turn started on an unknown tile
+			size_t tile = FindKnownTile(mFaces[mTurnTile], mTurnTile);
+			if (tile == mTileCount)
+				tile = PickUnknownTile(mTurnTile);
+			if (tile == mTileCount)
+				tile = (mTurnTile + 1) % mTileCount;
+			mPlannedPresses.push_back(tile);
+		}
+	}
+
+	size_t tile = mPlannedPresses.back();
+	mPlannedPresses.pop_back();
+	return tile;
+}
+
+void PerfectMemoryBot::Observe(size_t inTile, const std::string& inFace)
+{
+	if (!mKnown[inTile])
+	{
+		mKnown[inTile] = true;
+		mFaces[inTile] = inFace;
+		// The odd tile of a board has no pair
+		if (inFace.empty())
+			mDone[inTile] = true;
+	}
+
+	if (mTurnTile == mTileCount)
+	{
+		mTurnTile = inTile;
+	}
+	else
+	{
+		if (inTile != mTurnTile && !mFaces[inTile].empty() && mFaces[inTile] == mFaces[mTurnTile])
+		{
+			mDone[inTile] = true;
+			mDone[mTurnTile] = true;
+		}
+		mTurnTile = mTileCount;
+	}
+}
+
+void PerfectMemoryBot::PlanTurn()
+{
+	// A known pair first
+	for (size_t tile = 0; tile < mTileCount; tile++)
+	{
+		if (mKnown[tile] && !mDone[tile])
+		{
+			size_t partner = FindKnownTile(mFaces[tile], tile);
+			if (partner != mTileCount)
+			{
+				mPlannedPresses.push_back(partner);
+				mPlannedPresses.push_back(tile);
+				return;
+			}
+		}
+	}
+
+	// Otherwise an unknown tile, the second press is chosen once its face is seen
+	size_t tile = PickUnknownTile(mTileCount);
+	if (tile == mTileCount)
+	{
+		// Only the odd tile is left, the game is already solved
+		tile = 0;
+	}
+	mPlannedPresses.push_back(tile);
+}
+
+size_t PerfectMemoryBot::FindKnownTile(const std::string& inFace, size_t inExceptTile) const
+{
+	if (inFace.empty())
+		return mTileCount;
+
+	for (size_t tile = 0; tile < mTileCount; tile++)
+	{
+		if (tile != inExceptTile && mKnown[tile] && !mDone[tile] && mFaces[tile] == inFace)
+			return tile;
+	}
+	return mTileCount;
+}
+
+size_t PerfectMemoryBot::PickUnknownTile(size_t inExceptTile)
+{
+	size_t unknownCount = 0;
+	for (size_t tile = 0; tile < mTileCount; tile++)
+	{
+		if (!mKnown[tile] && tile != inExceptTile)
+			unknownCount++;
+	}
+	if (unknownCount == 0)
+		return mTileCount;
+
+	size_t pick = mRandom.NextBelow((uint32_t)unknownCount);
+	for (size_t tile = 0; tile < mTileCount; tile++)
+	{
+		if (!mKnown[tile] && tile != inExceptTile && pick-- == 0)
+			return tile;
+	}
+	return mTileCount;
+}
+
+void AdversarialBot::PlanTurn()
+{
+	mMismatchTurn = !mMismatchTurn;
+	if (mMismatchTurn)
+	{
+		// Two known tiles with different faces
+		for (size_t first = 0; first < mTileCount; first++)
+		{
+			if (!mKnown[first] || mDone[first])
+				continue;
+
+			for (size_t second = first + 1; second < mTileCount; second++)
+			{
+				if (mKnown[second] && !mDone[second] && mFaces[second] != mFaces[first])
+				{
+					mPlannedPresses.push_back(second);
+					mPlannedPresses.push_back(first);
+					return;
+				}
+			}
+		}
+	}
+
+	PerfectMemoryBot::PlanTurn();
+}
@@ -0,0 +1,117 @@
+//==============================================================================
+/**
+@file       GameBots.h
+
+@brief      Scripted players for MemoryGame, to play full games on a HeadlessGameSink
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+
+#pragma once
+
+#include "../MemoryGame/GameRandom.h"
+
+#include <string>
+#include <vector>
+
+// A player only sees what the keys show, like a person in front of the Stream Deck: it picks the tile to
+// press, then observes the face the tile shows after the press.
+class GameBot
+{
+public:
+
+	virtual ~GameBot() { }
+
+	virtual const char* GetName() const = 0;
+	// Virtual time between two presses
+	virtual int GetPressDelayMs() const = 0;
+
+	// A new board with inTileCount tiles was dealt, everything seen before is forgotten
+	virtual void NewGame(size_t inTileCount) = 0;
+	// The index of the tile to press next
+	virtual size_t NextPress() = 0;
+	// The face of the pressed tile after the press, empty if it shows nothing
+	virtual void Observe(size_t inTile, const std::string& inFace) = 0;
+};
+
+// Presses any tile, solved or not, at the pace of a person
+class RandomBot : public GameBot
+{
+public:
+
+	explicit RandomBot(uint64_t inSeed) : mRandom(inSeed) { }
+
+	const char* GetName() const override { return "random"; }
+	int GetPressDelayMs() const override { return 300; }
+
+	void NewGame(size_t inTileCount) override { mTileCount = inTileCount; }
+	size_t NextPress() override { return mRandom.NextBelow((uint32_t)mTileCount); }
+	void Observe(size_t /*inTile*/, const std::string& /*inFace*/) override { }
+
+private:
+
+	GameRandom mRandom;
+	size_t mTileCount = 0;
+};
+
+// Remembers every face it has seen. It presses a known pair if there is one, otherwise it turns an unknown
+// tile and then its partner if known, or another unknown tile. Never needs more presses than that.
+class PerfectMemoryBot : public GameBot
+{
+public:
+
+	explicit PerfectMemoryBot(uint64_t inSeed) : mRandom(inSeed) { }
+
+	const char* GetName() const override { return "perfect-memory"; }
+	int GetPressDelayMs() const override { return 300; }
+
+	void NewGame(size_t inTileCount) override;
+	size_t NextPress() override;
+	void Observe(size_t inTile, const std::string& inFace) override;
+
+protected:
+
+	// Plans the presses of the next turn into mPlannedPresses, at least the first one
+	virtual void PlanTurn();
+
+	// The index of a known unsolved tile with the face, mTileCount if there is none
+	size_t FindKnownTile(const std::string& inFace, size_t inExceptTile) const;
+	// A random tile that was not seen yet, mTileCount if all tiles were seen
+	size_t PickUnknownTile(size_t inExceptTile);
+
+	GameRandom mRandom;
+	size_t mTileCount = 0;
+
+	// Faces seen on the tiles, empty if not seen yet. Solved tiles and tiles without a face are done.
+	std::vector<std::string> mFaces;
+	std::vector<bool> mKnown;
+	std::vector<bool> mDone;
+
+	// The presses of the current turn, in reverse order
+	std::vector<size_t> mPlannedPresses;
+	// The first tile of the current turn, mTileCount before the first press
+	size_t mTurnTile = 0;
+};
+
+// Plays like PerfectMemoryBot, but presses two tiles it knows do not match before each turn, without
+// waiting for the mismatch to be hidden
+class AdversarialBot : public PerfectMemoryBot
+{
+public:
+
+	explicit AdversarialBot(uint64_t inSeed) : PerfectMemoryBot(inSeed) { }
+
+	const char* GetName() const override { return "adversarial"; }
+	int GetPressDelayMs() const override { return 20; }
+
+protected:
+
+	void PlanTurn() override;
+
+private:
+
+	bool mMismatchTurn = true;
+};
@@ -0,0 +1,67 @@
+//==============================================================================
+/**
+@file       HeadlessMemoryGame.cpp
+
+@brief      Plays MemoryGame with random key presses, without a Stream Deck
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+//
+// Usage: HeadlessMemoryGame [tile count] [press count] [seed]
+//
+// Runs the game logic of the plugin on a HeadlessGameSink: the presses go through
+// MemoryGame::HandleMemoryTilePressed(), the timers run on a virtual clock advancing 250 ms per press,
+// and the key changes are only counted. Built from the Sources folder with:
+//
+//   c++ -std=c++14 -O2 -include macOS/pch.h -I MemoryGame -I Common -o HeadlessMemoryGame Tools/HeadlessMemoryGame.cpp
+//       MemoryGame/HeadlessGameSink.cpp MemoryGame/MemoryGame.cpp MemoryGame/MemoryBoard.cpp
+//       MemoryGame/GameSession.cpp Common/ESDAnimation.cpp Common/ESDStringInterner.cpp
+
+#include "../MemoryGame/HeadlessGameSink.h"
+#include "../MemoryGame/MemoryGame.h"
+#include "../MemoryGame/GameRandom.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#define kHeadlessPressDelayMs 250
+
+int main(int argc, const char* argv[])
+{
+	const size_t tileCount = argc > 1 ? (size_t)std::strtoul(argv[1], nullptr, 10) : 15;
+	const uint64_t pressCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+	const uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+	if (tileCount < 2)
+	{
+		std::fprintf(stderr, "At least 2 tiles are needed\n");
+		return 1;
+	}
+
+	HeadlessGameSink sink("headless", tileCount, tileCount / 2);
+	MemoryGame game(&sink, sink.GetDeviceId());
+	game.SetRandomSeed(seed);
+	game.InitGame();
+
+	GameRandom random(seed);
+	const std::vector<ESDStringID>& tiles = sink.GetTileContexts();
+	sink.ResetCounters();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < pressCount; i++)
+	{
+		game.HandleMemoryTilePressed(tiles[random.NextBelow((uint32_t)tiles.size())]);
+		sink.AdvanceTime(kHeadlessPressDelayMs);
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("%zu tiles, %llu presses in %.3f s: %.0f presses/s\n", tileCount, (unsigned long long)pressCount,
+		seconds, (double)pressCount / seconds);
+	std::printf("%llu games solved, %.2f key changes and %.0f bytes per press\n",
+		(unsigned long long)sink.GetFinishedGameCount(),
+		(double)sink.GetSendCount() / (double)pressCount, (double)sink.GetSendBytes() / (double)pressCount);
+	return 0;
+}
@@ -0,0 +1,175 @@
+//==============================================================================
+/**
+@file       MemoryGameBench.cpp
+
+@brief      Plays full games with the scripted players and reports the throughput
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+//
+// Usage: MemoryGameBench [games per run] [seed]
+//
+// Each player of GameBots.h plays complete games on 2x3, 3x5 and 4x8 boards against the real MemoryGame
+// logic on a HeadlessGameSink. The virtual clock advances by the delay of the player after each press, and
+// runs the success animation to the next deal after each solved game. Reports per player and board:
+// games/s, presses, key changes (sends) and their bytes per game, and the peak thread count of the process.
+// Then reports the CPU time per reveal of the setImage message of a tile in ESDConnectionManager, see
+// RunRevealBench(). Built from the Sources folder with:
+//
+//   c++ -std=c++14 -O2 -include macOS/pch.h -I MemoryGame -I Common -I Vendor/asio/include -I Vendor/websocketpp
+//       -o MemoryGameBench Tools/MemoryGameBench.cpp Tools/GameBots.cpp MemoryGame/HeadlessGameSink.cpp
+//       MemoryGame/MemoryGame.cpp MemoryGame/MemoryBoard.cpp MemoryGame/GameSession.cpp Common/ESDAnimation.cpp
+//       Common/ESDStringInterner.cpp Common/ESDConnectionManager.cpp Common/ESDEventDecoder.cpp -lz -pthread
+
+#include "GameBots.h"
+#include "../Common/ESDConnectionManager.h"
+#include "../MemoryGame/HeadlessGameSink.h"
+#include "../MemoryGame/MemoryGame.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#if defined(__APPLE__)
+	#include <mach/mach.h>
+#elif defined(__linux__)
+	#include <fstream>
+#endif
+
+// Number of threads of the process, 0 if unknown on this platform
+static size_t GetThreadCount()
+{
+#if defined(__APPLE__)
+	thread_act_array_t threads = nullptr;
+	mach_msg_type_number_t count = 0;
+	if (task_threads(mach_task_self(), &threads, &count) != KERN_SUCCESS)
+		return 0;
+	for (mach_msg_type_number_t i = 0; i < count; i++)
+		mach_port_deallocate(mach_task_self(), threads[i]);
+	vm_deallocate(mach_task_self(), (vm_address_t)threads, count * sizeof(thread_act_t));
+	return count;
+#elif defined(__linux__)
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 8, "Threads:") == 0)
+			return (size_t)std::strtoul(line.c_str() + 8, nullptr, 10);
+	}
+	return 0;
+#else
+	return 0;
+#endif
+}
+
+struct BenchBoard
+{
+	const char* mName;
+	size_t mTileCount;
+};
+
+static void RunBench(GameBot& ioBot, const BenchBoard& inBoard, uint64_t inGameCount, uint64_t inSeed)
+{
+	HeadlessGameSink sink(std::string("bench-") + inBoard.mName, inBoard.mTileCount, inBoard.mTileCount / 2);
+	MemoryGame game(&sink, sink.GetDeviceId());
+	game.SetRandomSeed(inSeed);
+	game.InitGame();
+
+	const std::vector<ESDStringID>& tiles = sink.GetTileContexts();
+	ioBot.NewGame(tiles.size());
+	sink.ResetCounters();
+
+	uint64_t pressCount = 0;
+	size_t peakThreadCount = GetThreadCount();
+	const auto start = std::chrono::steady_clock::now();
+	while (sink.GetFinishedGameCount() < inGameCount)
+	{
+		const uint64_t finishedGameCount = sink.GetFinishedGameCount();
+		const size_t tile = ioBot.NextPress();
+		game.HandleMemoryTilePressed(tiles[tile]);
+		ioBot.Observe(tile, sink.GetTileFace(tile));
+		pressCount++;
+
+		if (sink.GetFinishedGameCount() != finishedGameCount)
+		{
+			// Play the success animation up to the next deal
+			while (sink.RunNextTimer())
+			{
+			}
+			ioBot.NewGame(tiles.size());
+			if (sink.GetFinishedGameCount() % 256 == 0)
+				peakThreadCount = std::max(peakThreadCount, GetThreadCount());
+		}
+		else
+		{
+			sink.AdvanceTime(ioBot.GetPressDelayMs());
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	peakThreadCount = std::max(peakThreadCount, GetThreadCount());
+
+	const double games = (double)inGameCount;
+	std::printf("%-15s %-4s %12.0f %10.1f %10.1f %12.0f %8zu\n", ioBot.GetName(), inBoard.mName, games / seconds,
+		(double)pressCount / games, (double)sink.GetSendCount() / games, (double)sink.GetSendBytes() / games,
+		peakThreadCount);
+}
+
+// CPU time per reveal of a tile in ESDConnectionManager. Without the prepared images, every reveal writes the
+// setImage message of the icon again; this is timed by preparing a different image id on each reveal, which
+// additionally allocates the message instead of taking it from the pool. With them, the message is prepared
+// once per deal and the reveal only looks it up and queues it. The manager is not connected, the messages are
+// queued and coalesced but not sent.
+static void RunRevealBench(uint64_t inRevealCount)
+{
+	HeadlessGameSink sink("bench-reveal", 32, 16);
+	const GameIcon& icon = sink.GetTileIcons()[0];
+	const ESDStringID context = sink.GetTileContexts()[0];
+	ESDConnectionManager connectionManager(0, "", "", "", nullptr);
+
+	const std::string imageIds[] = { icon.mId + "-a", icon.mId + "-b" };
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t reveal = 0; reveal < inRevealCount; reveal++)
+		connectionManager.PrepareImage(imageIds[reveal % 2], icon.mBase64Image, icon.mBase64ImageSize, context, kESDSDKTarget_HardwareAndSoftware);
+	const double rebuiltNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inRevealCount;
+
+	connectionManager.PrepareImage(icon.mId, icon.mBase64Image, icon.mBase64ImageSize, context, kESDSDKTarget_HardwareAndSoftware);
+	start = std::chrono::steady_clock::now();
+	for (uint64_t reveal = 0; reveal < inRevealCount; reveal++)
+		connectionManager.SetPreparedImage(icon.mId, context, kESDSDKTarget_HardwareAndSoftware);
+	const double preparedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inRevealCount;
+
+	std::printf("\nreveal of a %zu byte icon: %.0f ns writing the setImage message, %.0f ns with the prepared message\n",
+		icon.mBase64ImageSize, rebuiltNs, preparedNs);
+}
+
+int main(int argc, const char* argv[])
+{
+	const uint64_t gameCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+	const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+	if (gameCount == 0)
+	{
+		std::fprintf(stderr, "At least 1 game is needed\n");
+		return 1;
+	}
+
+	const BenchBoard boards[] = { { "2x3", 6 }, { "3x5", 15 }, { "4x8", 32 } };
+
+	std::printf("%-15s %-4s %12s %10s %10s %12s %8s\n", "player", "board", "games/s", "presses", "sends", "bytes", "threads");
+	for (const BenchBoard& board : boards)
+	{
+		std::unique_ptr<GameBot> bots[] = {
+			std::unique_ptr<GameBot>(new RandomBot(seed)),
+			std::unique_ptr<GameBot>(new PerfectMemoryBot(seed)),
+			std::unique_ptr<GameBot>(new AdversarialBot(seed))
+		};
+		for (auto& bot : bots)
+			RunBench(*bot, board, gameCount, seed);
+	}
+
+	RunRevealBench(100000);
+	return 0;
+}
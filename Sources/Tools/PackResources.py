@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#==============================================================================
+# @file       PackResources.py
+#
+# @brief      Packs the resources read by the plugin into resources.pack
+#
+# @copyright  (c) 2018, Corsair Memory, Inc.
+#             This source code is licensed under the MIT-style license found in the LICENSE file.
+#==============================================================================
+#
+# Usage: PackResources.py <Resources folder> <output file>
+#
+# The plugin maps the pack into memory and reads the resources in place, see ESDResourcePack.h for the format.
+# The PNG files are stored base64 encoded, ready for setImage. The localization files are stored as sorted
+# tables of the strings of their "Localization" object.
+
+import base64
+import json
+import os
+import struct
+import sys
+
+MAGIC = b'ESDPACK\0'
+VERSION = 1
+
+
+def build_table(strings):
+	keys = sorted(strings, key=lambda key: key.encode('utf-8'))
+	header = bytearray(struct.pack('<I', len(keys)))
+	data = bytearray()
+	offset = 4 + 16 * len(keys)
+	for key in keys:
+		key_bytes = key.encode('utf-8')
+		value_bytes = strings[key].encode('utf-8')
+		header += struct.pack('<IIII', offset + len(data), len(key_bytes), offset + len(data) + len(key_bytes), len(value_bytes))
+		data += key_bytes + value_bytes
+	return bytes(header + data)
+
+
+def collect_entries(resources_folder):
+	entries = {}
+	for name in sorted(os.listdir(resources_folder)):
+		path = os.path.join(resources_folder, name)
+		if name.endswith('.png'):
+			with open(path, 'rb') as file:
+				entries[name] = base64.b64encode(file.read())
+		elif name.endswith('.json') and name != 'manifest.json':
+			with open(path, 'rb') as file:
+				localization = json.loads(file.read().decode('utf-8-sig')).get('Localization', {})
+			entries[name] = build_table({key: value for key, value in localization.items() if isinstance(value, str)})
+	return entries
+
+
+def write_pack(entries, output_path):
+	names = sorted(entries, key=lambda name: name.encode('utf-8'))
+	offset = 16 + 16 * len(names)
+	index = bytearray()
+	blob = bytearray()
+	for name in names:
+		name_bytes = name.encode('utf-8')
+		index += struct.pack('<II', offset + len(blob), len(name_bytes))
+		blob += name_bytes
+		# Keep the data 4-byte aligned for the tables
+		blob += b'\0' * (-(offset + len(blob)) % 4)
+		index += struct.pack('<II', offset + len(blob), len(entries[name]))
+		blob += entries[name]
+	with open(output_path, 'wb') as file:
+		file.write(MAGIC + struct.pack('<II', VERSION, len(names)) + index + blob)
+
+
+if __name__ == '__main__':
+	if len(sys.argv) != 3:
+		sys.stderr.write('Usage: PackResources.py <Resources folder> <output file>\n')
+		sys.exit(1)
+	write_pack(collect_entries(sys.argv[1]), sys.argv[2])
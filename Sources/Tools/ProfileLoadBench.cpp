@@ -0,0 +1,113 @@
+//==============================================================================
+/**
+@file       ProfileLoadBench.cpp
+
+@brief      Measures the time from the first key of a profile load to the start of the game
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+//
+// Usage: ProfileLoadBench [load count]
+//
+// Loads the profile of an XL device as a burst of 32 willAppear events (31 tiles and a reset key) into an
+// ActionManager. The ActionManager reports the complete profile, and the game is then started on a
+// HeadlessGameSink with the same contexts. The profile is unloaded again after each load. Reports the mean,
+// median and 99th percentile of the burst alone and of the burst including the game start. The settle window
+// of MyStreamDeckPlugin is not part of this, it only waits. Built from the Sources folder with:
+//
+//   c++ -std=c++14 -O2 -include macOS/pch.h -I MemoryGame -I Common -o ProfileLoadBench Tools/ProfileLoadBench.cpp
+//       MemoryGame/ActionManager.cpp MemoryGame/StreamDeckAction.cpp MemoryGame/StreamDeckDevice.cpp
+//       MemoryGame/HeadlessGameSink.cpp MemoryGame/MemoryGame.cpp MemoryGame/MemoryBoard.cpp
+//       MemoryGame/GameSession.cpp Common/ESDAnimation.cpp Common/ESDStringInterner.cpp -pthread
+
+#include "../MemoryGame/ActionManager.h"
+#include "../MemoryGame/HeadlessGameSink.h"
+#include "../MemoryGame/MemoryGame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Starts the game on the headless sink once the profile is complete, like MyStreamDeckPlugin without the
+// settle window
+class BenchListener : public ActionManagerListener
+{
+public:
+
+	explicit BenchListener(HeadlessGameSink* inSink) : mSink(inSink) { }
+
+	void ProfileLoadedForDevice(ESDStringID inDeviceId) override
+	{
+		if (mStartGame && !mGame)
+			mGame.reset(new MemoryGame(mSink, inDeviceId));
+	}
+
+	void ActionOfActiveDeviceDisappeared(ESDStringID /*inDeviceId*/, ESDStringID /*inContext*/) override
+	{
+		mGame.reset();
+	}
+
+	bool mStartGame = true;
+
+private:
+
+	HeadlessGameSink* mSink = nullptr;
+	std::unique_ptr<MemoryGame> mGame;
+};
+
+static void PrintTimes(const char* inName, std::vector<double>& ioTimesUs)
+{
+	std::sort(ioTimesUs.begin(), ioTimesUs.end());
+	double sum = 0.0;
+	for (double time : ioTimesUs)
+		sum += time;
+	std::printf("%-22s mean %8.2f us, median %8.2f us, p99 %8.2f us\n", inName, sum / ioTimesUs.size(),
+		ioTimesUs[ioTimesUs.size() / 2], ioTimesUs[ioTimesUs.size() * 99 / 100]);
+}
+
+int main(int argc, const char* argv[])
+{
+	const int loadCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+	if (loadCount < 1)
+	{
+		std::fprintf(stderr, "At least 1 load is needed\n");
+		return 1;
+	}
+
+	HeadlessGameSink sink("bench-xl", 31, 15);
+	BenchListener listener(&sink);
+	ActionManager actionManager(&listener);
+	actionManager.AddDevice(StreamDeckDevice(sink.GetDeviceId(), 4, 8));
+
+	std::vector<StreamDeckAction> actions;
+	for (ESDStringID context : sink.GetTileContexts())
+		actions.push_back(StreamDeckAction(context, sink.GetDeviceId(), StreamDeckAction::GetTileType()));
+	actions.push_back(StreamDeckAction(sink.GetResetContext(), sink.GetDeviceId(), StreamDeckAction::GetResetType()));
+
+	std::vector<double> burstTimesUs;
+	std::vector<double> startTimesUs;
+	for (int run = 0; run < 2 * loadCount; run++)
+	{
+		// Alternate between the burst alone and the burst with the game start
+		listener.mStartGame = run % 2 == 1;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (const StreamDeckAction& action : actions)
+			actionManager.AddAction(action);
+		const double timeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		(listener.mStartGame ? startTimesUs : burstTimesUs).push_back(timeUs);
+
+		for (const StreamDeckAction& action : actions)
+			actionManager.RemoveAction(action);
+	}
+
+	PrintTimes("32 key burst", burstTimesUs);
+	PrintTimes("burst and game start", startTimesUs);
+	return 0;
+}
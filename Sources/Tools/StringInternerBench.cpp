@@ -0,0 +1,147 @@
+//==============================================================================
+/**
+@file       StringInternerBench.cpp
+
+@brief      Compares the interned handles of the contexts, devices and actions with the strings
+
+@copyright  (c) 2018, Corsair Memory, Inc.
+			This source code is licensed under the MIT-style license found in the LICENSE file.
+
+**/
+//==============================================================================
+//
+// Usage: StringInternerBench [lookups per measurement]
+//
+// Builds the actions of three XL devices with random 32 hex digit contexts and device ids, like the Stream Deck
+// application sends them, once as strings (StringAction, the layout StreamDeckAction had before the handles)
+// and once as StreamDeckAction. Reports the memory of an action and of a context per container, the time of
+// a find in an ordered set of the actions and in a map by context, and the time to intern the three strings
+// of an event compared with copying them. Built from the Sources folder with:
+//
+//   c++ -std=c++14 -O2 -include macOS/pch.h -I MemoryGame -I Common -o StringInternerBench Tools/StringInternerBench.cpp
+//       MemoryGame/StreamDeckAction.cpp Common/ESDStringInterner.cpp
+
+#include "../MemoryGame/StreamDeckAction.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#define kBenchDeviceCount 3
+#define kBenchKeyCount 32
+
+struct StringAction
+{
+	std::string mContext;
+	std::string mDeviceId;
+	std::string mActionType;
+};
+
+static bool operator< (const StringAction& inLhs, const StringAction& inRhs)
+{
+	return std::tie(inLhs.mContext, inLhs.mDeviceId, inLhs.mActionType) < std::tie(inRhs.mContext, inRhs.mDeviceId, inRhs.mActionType);
+}
+
+static std::string GetRandomHexString(std::mt19937& ioRandom)
+{
+	static const char kHexDigits[] = "0123456789ABCDEF";
+	std::string string(32, '0');
+	for (char& digit : string)
+		digit = kHexDigits[ioRandom() % 16];
+	return string;
+}
+
+// Heap and inline bytes of a string, without the overhead of the allocator
+static size_t GetStringBytes(const std::string& inString)
+{
+	bool isInline = (const char*)&inString <= inString.data() && inString.data() < (const char*)&inString + sizeof(std::string);
+	return sizeof(std::string) + (isInline ? 0 : inString.capacity() + 1);
+}
+
+// Average time of a call of inFunction in ns, over inCount calls
+template <typename Function>
+static double TimeNs(size_t inCount, const Function& inFunction)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < inCount; i++)
+		inFunction(i);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / inCount;
+}
+
+int main(int argc, const char* argv[])
+{
+	const size_t lookupCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+	if (lookupCount == 0)
+	{
+		std::fprintf(stderr, "At least 1 lookup is needed\n");
+		return 1;
+	}
+
+	std::mt19937 random(1);
+	ESDStringInterner& interner = ESDStringInterner::Get();
+
+	std::vector<StringAction> stringActions;
+	std::vector<StreamDeckAction> actions;
+	for (int device = 0; device < kBenchDeviceCount; device++)
+	{
+		std::string deviceId = GetRandomHexString(random);
+		for (int key = 0; key < kBenchKeyCount; key++)
+		{
+			StringAction stringAction { GetRandomHexString(random), deviceId, kActionNameTile };
+			stringActions.push_back(stringAction);
+			actions.push_back(StreamDeckAction(interner.Intern(stringAction.mContext), interner.Intern(deviceId), interner.Intern(stringAction.mActionType)));
+		}
+	}
+
+	// Memory
+	const StringAction& sample = stringActions[0];
+	std::printf("action:  %zu bytes as strings (%zu inline), %zu bytes with handles\n",
+		GetStringBytes(sample.mContext) + GetStringBytes(sample.mDeviceId) + GetStringBytes(sample.mActionType),
+		sizeof(StringAction), sizeof(StreamDeckAction));
+	std::printf("context: %zu bytes per container as a string, %zu bytes as a handle\n",
+		GetStringBytes(sample.mContext), sizeof(ESDStringID));
+
+	// Lookups
+	std::set<StringAction> stringActionSet(stringActions.begin(), stringActions.end());
+	std::set<StreamDeckAction> actionSet(actions.begin(), actions.end());
+	std::unordered_map<std::string, size_t> stringContextMap;
+	std::unordered_map<ESDStringID, size_t> contextMap;
+	for (size_t i = 0; i < actions.size(); i++)
+	{
+		stringContextMap[stringActions[i].mContext] = i;
+		contextMap[actions[i].mContext] = i;
+	}
+
+	size_t found = 0;
+	const double stringSetNs = TimeNs(lookupCount, [&](size_t i) { found += stringActionSet.count(stringActions[i % stringActions.size()]); });
+	const double setNs = TimeNs(lookupCount, [&](size_t i) { found += actionSet.count(actions[i % actions.size()]); });
+	const double stringMapNs = TimeNs(lookupCount, [&](size_t i) { found += stringContextMap.count(stringActions[i % stringActions.size()].mContext); });
+	const double mapNs = TimeNs(lookupCount, [&](size_t i) { found += contextMap.count(actions[i % actions.size()].mContext); });
+	std::printf("action set find:  %6.1f ns with strings, %6.1f ns with handles\n", stringSetNs, setNs);
+	std::printf("context map find: %6.1f ns with strings, %6.1f ns with handles\n", stringMapNs, mapNs);
+
+	// Inbound events: the three strings are interned instead of copied into the event
+	StringAction copy;
+	const double copyNs = TimeNs(lookupCount, [&](size_t i)
+	{
+		const StringAction& action = stringActions[i % stringActions.size()];
+		copy = StringAction { action.mContext, action.mDeviceId, action.mActionType };
+		found += copy.mContext.size();
+	});
+	const double internNs = TimeNs(lookupCount, [&](size_t i)
+	{
+		const StringAction& action = stringActions[i % stringActions.size()];
+		found += interner.Intern(action.mContext) + interner.Intern(action.mDeviceId) + interner.Intern(action.mActionType);
+	});
+	std::printf("event fields:     %6.1f ns copying the strings, %6.1f ns interning them\n", copyNs, internNs);
+
+	// Keeps the lookups from being optimized away
+	if (found == 0)
+		std::printf("nothing found\n");
+	return 0;
+}